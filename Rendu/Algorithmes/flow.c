@@ -0,0 +1,3822 @@
+// Bibliothèque de flot (voir flow.h) : compilée une fois et liée à chacun des programmes.
+#define _GNU_SOURCE    // Extensions POSIX et GNU (mmap, barrières de threads)
+#include <stdio.h>      // Inclusion de la bibliothèque standard d'entrée/sortie
+#include <stdlib.h>     // Inclusion de la bibliothèque standard pour malloc, free, etc.
+#include <string.h>     // Inclusion de la bibliothèque pour strcmp, etc.
+#include <limits.h>     // Inclusion de la bibliothèque pour INT_MAX
+#include <time.h>
+#include <math.h>
+#include <stdint.h>     // Types de taille fixe du format binaire
+#include <fcntl.h>      // open
+#include <unistd.h>     // close
+#include <sys/mman.h>   // mmap, munmap
+#include <sys/stat.h>   // fstat
+#include <pthread.h>    // Analyse parallèle des fichiers texte
+#include <sched.h>      // Placement des threads sur les cœurs
+#include "flow.h"
+
+#ifndef FLOW_SIMD                       // Noyaux AVX2 / AVX-512 choisis à l'exécution (0 : scalaire seul)
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FLOW_SIMD 1
+#else
+#define FLOW_SIMD 0
+#endif
+#endif
+#if FLOW_SIMD
+#include <immintrin.h>
+#endif
+
+// Format binaire versionné des graphes (.bin) : un en-tête suivi des tableaux CSR tels qu'ils
+// sont en mémoire, chacun aligné sur 64 octets. Le fichier est projeté avec mmap et les
+// solveurs lisent les tableaux sur place, sans copie ni analyse de texte.
+#define FLOW_BIN_MAGIC "FLOWCSR"        // 8 octets avec le zéro final
+#define FLOW_BIN_VERSION 3                // Version 2 : ajoute demand et input_nodes ; version 3 : largeurs dans flags
+#define FLOW_BIN_BYTE_ORDER 0x01020304u // Relu différemment si le fichier vient d'une machine d'un autre boutisme
+#define FLOW_BIN_HAS_COST 1u            // Drapeau : le fichier contient le tableau des coûts
+#define FLOW_BIN_CAP_BYTES(flags) (((flags) >> 8 & 0xffu) ? ((flags) >> 8 & 0xffu) : 4u)   // Octets d'une capacité
+#define FLOW_BIN_COST_BYTES(flags) (((flags) >> 16 & 0xffu) ? ((flags) >> 16 & 0xffu) : 4u) // Octets d'un coût
+#define FLOW_BIN_ALIGN 64
+
+typedef struct {
+    char magic[8];              // FLOW_BIN_MAGIC
+    uint32_t version;           // FLOW_BIN_VERSION
+    uint32_t byte_order;        // FLOW_BIN_BYTE_ORDER dans l'ordre de l'écrivain
+    uint32_t flags;             // FLOW_BIN_HAS_COST, octets d'une capacité (bits 8-15) et d'un coût (bits 16-23)
+    int32_t n, s, t;            // Sommets, source et puits
+    int64_t m;                  // Nombre d'arcs du graphe résiduel
+    int64_t offset_first;       // Position (en octets) de first[n+1]
+    int64_t offset_head;        // Position de head[m]
+    int64_t offset_rev;         // Position de rev[m]
+    int64_t offset_capacity;    // Position de capacity[m]
+    int64_t offset_cost;        // Position de cost[m], 0 si pas de coûts
+    int32_t demand;             // Version 2 : flot imposé par le fichier
+    int32_t input_nodes;        // Version 2 : sommets décrits par le fichier d'origine
+} FlowBinaryHeader;
+
+#define FLOW_BIN_V1_HEADER_SIZE 80      // Taille de l'en-tête de la version 1 (sans demand ni input_nodes)
+
+// Alloue un tableau de count cases de size octets aligné sur FLOW_BIN_ALIGN octets, comme les tableaux
+// d'un fichier binaire projeté : les noyaux vectoriels lisent ainsi les mêmes lignes de cache dans les deux cas
+static void *alloc_arc_array(int count, size_t size) {
+    size_t bytes = ((size_t)(count > 0 ? count : 1) * size + FLOW_BIN_ALIGN - 1) / FLOW_BIN_ALIGN * FLOW_BIN_ALIGN;
+    return aligned_alloc(FLOW_BIN_ALIGN, bytes);
+}
+
+// Construit le graphe CSR de G à partir d'une liste de num_edges arcs (tail[e] -> head[e]).
+// Chaque arc e donne un arc direct (capacité cap[e], coût cost[e]) et un arc inverse
+// (capacité 0, coût -cost[e]). Les arcs sortants de chaque sommet sont triés par sommet
+// d'arrivée (tri par base en deux passes), ce qui conserve l'ordre de parcours de la matrice.
+// Si edge_arc n'est pas NULL, edge_arc[e] reçoit l'indice CSR de l'arc direct de e.
+// Retourne 1 en cas de succès, 0 si l'allocation échoue.
+static int build_csr_arcs(FlowNetwork *G, int num_edges, const int *tail, const int *head, const flow_cap_t *cap, const flow_cost_t *cost, int *edge_arc) {
+    int n = G->n;
+    int m = 2 * num_edges;                                 // Un arc direct et un arc inverse par arc du fichier
+    int *count = (int *)calloc(n + 1, sizeof(int));        // Compteurs du tri par base
+    int *order = (int *)malloc((m > 0 ? m : 1) * sizeof(int)); // Demi-arcs triés par sommet d'arrivée
+    int *pos = (int *)malloc((m > 0 ? m : 1) * sizeof(int));   // pos[h] : indice CSR final du demi-arc h
+    G->m = m;
+    G->first = (int *)calloc(n + 1, sizeof(int));
+    G->head = (int *)alloc_arc_array(m, sizeof(int));
+    G->rev = (int *)alloc_arc_array(m, sizeof(int));
+    G->capacity = (flow_cap_t *)alloc_arc_array(m, sizeof(flow_cap_t));
+    G->cost = cost ? (flow_cost_t *)alloc_arc_array(m, sizeof(flow_cost_t)) : NULL;
+    G->mapping = NULL;                                     // Tableaux alloués, pas projetés
+    G->mapping_size = 0;
+    G->demand = 0;
+    G->input_nodes = n;
+    G->arc_flow = NULL;
+    if (!count || !order || !pos || !G->first || !G->head || !G->rev || !G->capacity || (cost && !G->cost)) {
+        free(count); free(order); free(pos);
+        free(G->first); free(G->head); free(G->rev); free(G->capacity); free(G->cost);
+        return 0;
+    }
+
+    // Le demi-arc h < num_edges est l'arc direct e = h, le demi-arc h >= num_edges est l'inverse de e = h - num_edges
+    #define HALF_TAIL(h) ((h) < num_edges ? tail[(h)] : head[(h) - num_edges])
+    #define HALF_HEAD(h) ((h) < num_edges ? head[(h)] : tail[(h) - num_edges])
+
+    // Passe 1 : tri par sommet d'arrivée
+    for (int h = 0; h < m; h++) count[HALF_HEAD(h) + 1]++;
+    for (int v = 0; v < n; v++) count[v + 1] += count[v];
+    for (int h = 0; h < m; h++) order[count[HALF_HEAD(h)]++] = h;
+
+    // Passe 2 : tri stable par sommet de départ, qui donne directement les indices CSR
+    for (int h = 0; h < m; h++) G->first[HALF_TAIL(h) + 1]++;
+    for (int u = 0; u < n; u++) G->first[u + 1] += G->first[u];
+    memcpy(count, G->first, (n + 1) * sizeof(int));
+    for (int k = 0; k < m; k++) {
+        int h = order[k];
+        pos[h] = count[HALF_TAIL(h)]++;
+    }
+
+    for (int e = 0; e < num_edges; e++) {           // Remplit les arcs directs et inverses appariés
+        int a = pos[e], b = pos[e + num_edges];
+        G->head[a] = head[e];
+        G->head[b] = tail[e];
+        G->rev[a] = b;
+        G->rev[b] = a;
+        G->capacity[a] = cap[e];
+        G->capacity[b] = 0;
+        if (edge_arc) edge_arc[e] = a;
+        if (cost) {
+            G->cost[a] = cost[e];
+            G->cost[b] = -cost[e];
+        }
+    }
+    #undef HALF_TAIL
+    #undef HALF_HEAD
+
+    free(count);
+    free(order);
+    free(pos);
+    return 1;
+}
+
+int build_csr(FlowNetwork *G, int num_edges, const int *tail, const int *head, const flow_cap_t *cap, const flow_cost_t *cost) {
+    return build_csr_arcs(G, num_edges, tail, head, cap, cost, NULL);
+}
+
+// Fonction pour libérer la mémoire d'un réseau de flot
+void free_flow_network(FlowNetwork *G) {
+    if (G->mapping) {   // Graphe chargé depuis un fichier binaire : on libère seulement la projection
+        munmap(G->mapping, G->mapping_size);
+        G->mapping = NULL;
+        return;
+    }
+    free(G->first);
+    free(G->head);
+    free(G->rev);
+    free(G->capacity);
+    free(G->cost);      // free(NULL) ne fait rien si pas de coûts
+}
+
+// Recopie dans G->arc_flow (si demandé) le flot de chaque arc direct, déduit des capacités résiduelles
+static void export_arc_flow(const FlowNetwork *G, const flow_cap_t *residual) {
+    if (!G->arc_flow) return;
+    for (int a = 0; a < G->m; a++)
+        G->arc_flow[a] = (G->capacity[a] > 0) ? G->capacity[a] - residual[a] : 0;
+}
+
+// Affiche sous forme de matrice n x n, avec un titre, les valeurs des arcs directs de G : values[a]
+// si values n'est pas NULL, sinon les coûts G->cost[a]
+static void print_arc_values(const FlowNetwork *G, const flow_cap_t *values, const char *title) {
+    int n = G->n;
+    long long *row = (long long *)malloc(n * sizeof(long long)); // Ligne reconstruite à partir des arcs sortants
+    printf("%s\n", title);              // Affiche le titre
+    for (int i = 0; i < n; i++) {       // Parcourt chaque ligne
+        memset(row, 0, n * sizeof(long long));
+        for (int a = G->first[i]; a < G->first[i + 1]; a++) {
+            if (G->capacity[a] > 0) row[G->head[a]] = values ? values[a] : G->cost[a]; // Seuls les arcs directs sont affichés
+        }
+        for (int j = 0; j < n; j++) {   // Parcourt chaque colonne
+            printf("%4lld ", row[j]);   // Affiche la valeur (i,j) avec un espacement
+        }
+        printf("\n");                  // Retour à la ligne après chaque ligne de la matrice
+    }
+    printf("\n");                       // Ligne vide après la matrice
+    free(row);
+}
+
+// Fonction pour afficher les valeurs des arcs directs de G (capacités, flots) sous forme de matrice n x n
+void print_matrix(const FlowNetwork *G, const flow_cap_t *values, const char *title) {
+    print_arc_values(G, values, title);
+}
+
+// Fonction pour afficher les coûts des arcs directs de G sous forme de matrice n x n
+void print_cost_matrix(const FlowNetwork *G, const char *title) {
+    print_arc_values(G, NULL, title);
+}
+
+// Écrit un tableau de count cases de size octets dans f puis complète avec des zéros jusqu'au prochain
+// multiple de FLOW_BIN_ALIGN
+static int write_aligned_array(FILE *f, const void *data, size_t size, int64_t count, int64_t *offset) {
+    static const char zeros[FLOW_BIN_ALIGN] = {0};
+    if (count > 0 && fwrite(data, size, (size_t)count, f) != (size_t)count) return 0;
+    *offset += count * (int64_t)size;
+    int64_t pad = (FLOW_BIN_ALIGN - *offset % FLOW_BIN_ALIGN) % FLOW_BIN_ALIGN;
+    if (pad > 0 && fwrite(zeros, 1, (size_t)pad, f) != (size_t)pad) return 0;
+    *offset += pad;
+    return 1;
+}
+
+// Sauvegarde G au format binaire. Retourne 1 en cas de succès, 0 sinon.
+int write_binary_file(const char *filename, const FlowNetwork *G) {
+    FILE *f = fopen(filename, "wb");
+    if (!f) {
+        fprintf(stderr, "Impossible de créer le fichier %s.\n", filename);
+        return 0;
+    }
+
+    FlowBinaryHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, FLOW_BIN_MAGIC, sizeof(h.magic));
+    h.version = FLOW_BIN_VERSION;
+    h.byte_order = FLOW_BIN_BYTE_ORDER;
+    h.flags = (G->cost ? FLOW_BIN_HAS_COST : 0) | (uint32_t)sizeof(flow_cap_t) << 8 | (uint32_t)sizeof(flow_cost_t) << 16;
+    h.n = G->n;
+    h.s = G->s;
+    h.t = G->t;
+    h.m = G->m;
+    h.demand = G->demand;
+    h.input_nodes = G->input_nodes;
+
+    // Les positions se déduisent des tailles : l'en-tête puis chaque tableau, alignés
+    int64_t offset = ((int64_t)sizeof(h) + FLOW_BIN_ALIGN - 1) / FLOW_BIN_ALIGN * FLOW_BIN_ALIGN;
+    int64_t arrays_bytes = ((int64_t)G->m * sizeof(int32_t) + FLOW_BIN_ALIGN - 1) / FLOW_BIN_ALIGN * FLOW_BIN_ALIGN;
+    int64_t capacity_bytes = ((int64_t)G->m * sizeof(flow_cap_t) + FLOW_BIN_ALIGN - 1) / FLOW_BIN_ALIGN * FLOW_BIN_ALIGN;
+    h.offset_first = offset;
+    h.offset_head = h.offset_first + ((int64_t)(G->n + 1) * sizeof(int32_t) + FLOW_BIN_ALIGN - 1) / FLOW_BIN_ALIGN * FLOW_BIN_ALIGN;
+    h.offset_rev = h.offset_head + arrays_bytes;
+    h.offset_capacity = h.offset_rev + arrays_bytes;
+    h.offset_cost = G->cost ? h.offset_capacity + capacity_bytes : 0;
+
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    int64_t written = sizeof(h);
+    ok = ok && write_aligned_array(f, NULL, 1, 0, &written);    // Bourrage après l'en-tête
+    ok = ok && write_aligned_array(f, G->first, sizeof(int32_t), G->n + 1, &written);
+    ok = ok && write_aligned_array(f, G->head, sizeof(int32_t), G->m, &written);
+    ok = ok && write_aligned_array(f, G->rev, sizeof(int32_t), G->m, &written);
+    ok = ok && write_aligned_array(f, G->capacity, sizeof(flow_cap_t), G->m, &written);
+    if (G->cost) ok = ok && write_aligned_array(f, G->cost, sizeof(flow_cost_t), G->m, &written);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Erreur d'écriture dans le fichier %s.\n", filename);
+    return ok;
+}
+
+// Indique si filename commence par l'en-tête du format binaire
+int is_binary_file(const char *filename) {
+    char magic[8];
+    FILE *f = fopen(filename, "rb");
+    if (!f) return 0;
+    int ok = fread(magic, 1, sizeof(magic), f) == sizeof(magic) && memcmp(magic, FLOW_BIN_MAGIC, sizeof(magic)) == 0;
+    fclose(f);
+    return ok;
+}
+
+// Charge un fichier binaire par projection mémoire : les tableaux de G pointent directement
+// dans la projection (en lecture seule), aucun tableau n'est alloué ni copié. Les capacités et les
+// coûts du fichier doivent donc avoir la largeur de compilation (FLOW_CAP_BITS, FLOW_COST_BITS).
+int read_binary_file(const char *filename, FlowNetwork *G) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Impossible d'ouvrir le fichier %s. Vérifiez le nom et réessayez.\n", filename);
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < FLOW_BIN_V1_HEADER_SIZE) {
+        fprintf(stderr, "Fichier binaire %s tronqué.\n", filename);
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                                   // La projection reste valide après close
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Impossible de projeter le fichier %s en mémoire.\n", filename);
+        return 0;
+    }
+
+    const FlowBinaryHeader *h = (const FlowBinaryHeader *)map;
+    const char *error = NULL;
+    if (memcmp(h->magic, FLOW_BIN_MAGIC, sizeof(h->magic)) != 0) error = "en-tête inconnu";
+    else if (h->byte_order != FLOW_BIN_BYTE_ORDER) error = "boutisme différent de cette machine";
+    else if (h->version < 1 || h->version > FLOW_BIN_VERSION) error = "version non prise en charge";
+    else if (h->version >= 2 && size < sizeof(FlowBinaryHeader)) error = "en-tête tronqué";
+    else if (FLOW_BIN_CAP_BYTES(h->flags) != sizeof(flow_cap_t)) error = "largeur des capacités différente de FLOW_CAP_BITS (reconvertir le fichier)";
+    else if ((h->flags & FLOW_BIN_HAS_COST) && FLOW_BIN_COST_BYTES(h->flags) != sizeof(flow_cost_t))
+        error = "largeur des coûts différente de FLOW_COST_BITS (reconvertir le fichier)";
+    else if (h->n <= 0 || h->m < 0 || h->m > INT_MAX || h->s < 0 || h->s >= h->n || h->t < 0 || h->t >= h->n) error = "en-tête incohérent";
+    else {
+        int64_t arrays = h->m * (int64_t)sizeof(int32_t);
+        int64_t offsets[5] = {h->offset_first, h->offset_head, h->offset_rev, h->offset_capacity, h->offset_cost};
+        int64_t lengths[5] = {(int64_t)(h->n + 1) * (int64_t)sizeof(int32_t), arrays, arrays,
+                              h->m * (int64_t)sizeof(flow_cap_t), h->m * (int64_t)sizeof(flow_cost_t)};
+        int64_t sizes[5] = {sizeof(int32_t), sizeof(int32_t), sizeof(int32_t), sizeof(flow_cap_t), sizeof(flow_cost_t)};
+        int count = (h->flags & FLOW_BIN_HAS_COST) ? 5 : 4;
+        for (int k = 0; k < count && !error; k++) {
+            if (offsets[k] < FLOW_BIN_V1_HEADER_SIZE || offsets[k] % sizes[k] != 0
+                || offsets[k] + lengths[k] > (int64_t)size)
+                error = "tableau hors du fichier";
+        }
+        if (!error) {                            // Contrôle en O(n + m) de la structure CSR, en lecture seule
+            const int32_t *first = (const int32_t *)((const char *)map + h->offset_first);
+            const int32_t *head = (const int32_t *)((const char *)map + h->offset_head);
+            const int32_t *rev = (const int32_t *)((const char *)map + h->offset_rev);
+            if (first[0] != 0 || first[h->n] != h->m) error = "tableau first incohérent";
+            for (int u = 0; u < h->n && !error; u++)
+                if (first[u] > first[u + 1]) error = "tableau first incohérent";
+            // Les solveurs indexent leurs tableaux par head[a] et rev[a] : chaque arc doit viser un sommet,
+            // et son inverse doit partir de ce sommet et revenir sur lui
+            for (int a = 0; a < (int)h->m && !error; a++) {
+                int v = head[a], b = rev[a];
+                if (v < 0 || v >= h->n || b < 0 || b >= h->m || rev[b] != a || b < first[v] || b >= first[v + 1])
+                    error = "tableau head/rev incohérent";
+            }
+        }
+    }
+    if (error) {
+        fprintf(stderr, "Fichier binaire %s invalide : %s.\n", filename, error);
+        munmap(map, size);
+        return 0;
+    }
+
+    char *base = (char *)map;
+    G->n = h->n;
+    G->m = (int)h->m;
+    G->s = h->s;
+    G->t = h->t;
+    G->first = (int *)(base + h->offset_first);
+    G->head = (int *)(base + h->offset_head);
+    G->rev = (int *)(base + h->offset_rev);
+    G->capacity = (flow_cap_t *)(base + h->offset_capacity);
+    G->cost = (h->flags & FLOW_BIN_HAS_COST) ? (flow_cost_t *)(base + h->offset_cost) : NULL;
+    G->isMinCost = G->cost != NULL;
+    G->mapping = map;
+    G->mapping_size = size;
+    G->demand = (h->version >= 2) ? h->demand : 0;
+    G->input_nodes = (h->version >= 2 && h->input_nodes > 0 && h->input_nodes <= h->n) ? h->input_nodes : h->n;
+    G->arc_flow = NULL;
+    return 1;
+}
+
+// Analyse parallèle du format texte : le fichier est projeté en mémoire et découpé en morceaux
+// alignés sur des fins de ligne. Une première passe compte les nombres de chaque morceau (ce qui
+// donne l'indice global de son premier nombre), une seconde les convertit et garde les arcs.
+#define PARSE_BYTES_PER_THREAD (1 << 20)    // Volume minimal de texte confié à un thread
+#define PARSE_MAX_THREADS 64
+
+typedef struct {
+    const char *begin, *end;    // Morceau de texte à analyser
+    int n;                      // Nombre de sommets
+    int64_t first_token;        // Indice global (dans les matrices) du premier nombre du morceau
+    int64_t num_tokens;         // Nombre de nombres du morceau (passe 1)
+    int num_edges, max_edges;   // Arcs de capacité positive trouvés (passe 2), dans l'ordre des lignes
+    int *tail, *head;
+    flow_cap_t *cap;
+    int num_costs, max_costs;   // Coûts non nuls trouvés (passe 2), repérés par leur case i*n+j
+    int64_t *cost_cell;
+    flow_cost_t *cost_value;
+    int ok;                     // 0 si une allocation a échoué
+    int too_large;              // 1 si une valeur dépasse la largeur des capacités ou des coûts
+} ParseChunk;
+
+#define IS_BLANK(c) ((unsigned char)(c) <= ' ')   // Espaces, tabulations et fins de ligne
+
+// Passe 1 : compte les nombres du morceau
+static void *parse_count_tokens(void *arg) {
+    ParseChunk *C = (ParseChunk *)arg;
+    int64_t count = 0;
+    int in_token = 0;
+    for (const char *p = C->begin; p < C->end; p++) {
+        int blank = IS_BLANK(*p);
+        count += (!blank && !in_token);
+        in_token = !blank;
+    }
+    C->num_tokens = count;
+    return NULL;
+}
+
+// Passe 2 : convertit les nombres du morceau ; la case k < n*n est une capacité,
+// n*n <= k < 2*n*n un coût, au-delà le texte est ignoré
+static void *parse_chunk_values(void *arg) {
+    ParseChunk *C = (ParseChunk *)arg;
+    int64_t nn = (int64_t)C->n * C->n;
+    int64_t k = C->first_token;
+    const char *p = C->begin, *end = C->end;
+    C->ok = 1;
+    while (p < end && k < 2 * nn) {
+        while (p < end && IS_BLANK(*p)) p++;     // Saute les blancs
+        if (p == end) break;
+        int negative = 0;
+        if (*p == '-' || *p == '+') negative = (*p++ == '-');
+        long long value = 0;
+        int big = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (value > (LLONG_MAX - 9) / 10) big = 1;
+            else value = value * 10 + (*p - '0');
+        }
+        while (p < end && !IS_BLANK(*p)) p++;    // Reste d'un nombre mal formé
+        if (negative) value = -value;
+        if (big || (k < nn ? value > FLOW_CAP_MAX : (value > FLOW_COST_MAX || value < -FLOW_COST_MAX))) {
+            C->too_large = 1;                    // Refusé par read_input_file
+            value = 0;
+        }
+
+        if (value != 0) {
+            int i = (int)((k % nn) / C->n), j = (int)(k % C->n);
+            if (k < nn) {
+                if (value > 0 && i != j) {       // Seuls les arcs de capacité positive sont conservés
+                    if (C->num_edges == C->max_edges) {
+                        C->max_edges = C->max_edges ? 2 * C->max_edges : 1024;
+                        int *t = (int *)realloc(C->tail, C->max_edges * sizeof(int));
+                        if (t) C->tail = t;
+                        int *h = (int *)realloc(C->head, C->max_edges * sizeof(int));
+                        if (h) C->head = h;
+                        flow_cap_t *c = (flow_cap_t *)realloc(C->cap, C->max_edges * sizeof(flow_cap_t));
+                        if (c) C->cap = c;
+                        if (!t || !h || !c) { C->ok = 0; return NULL; }
+                    }
+                    C->tail[C->num_edges] = i;
+                    C->head[C->num_edges] = j;
+                    C->cap[C->num_edges] = (flow_cap_t)value;
+                    C->num_edges++;
+                }
+            } else {
+                if (C->num_costs == C->max_costs) {
+                    C->max_costs = C->max_costs ? 2 * C->max_costs : 1024;
+                    int64_t *cc = (int64_t *)realloc(C->cost_cell, C->max_costs * sizeof(int64_t));
+                    if (cc) C->cost_cell = cc;
+                    flow_cost_t *cv = (flow_cost_t *)realloc(C->cost_value, C->max_costs * sizeof(flow_cost_t));
+                    if (cv) C->cost_value = cv;
+                    if (!cc || !cv) { C->ok = 0; return NULL; }
+                }
+                C->cost_cell[C->num_costs] = k - nn;
+                C->cost_value[C->num_costs] = (flow_cost_t)value;
+                C->num_costs++;
+            }
+        }
+        k++;
+    }
+    return NULL;
+}
+
+// Lance worker sur chaque morceau, dans des threads si le fichier est assez gros
+static void parse_run(ParseChunk *chunks, int num_chunks, void *(*worker)(void *)) {
+    pthread_t threads[PARSE_MAX_THREADS];
+    int started[PARSE_MAX_THREADS] = {0};
+    for (int c = 1; c < num_chunks; c++)
+        started[c] = pthread_create(&threads[c], NULL, worker, &chunks[c]) == 0;
+    worker(&chunks[0]);                          // Le thread appelant traite le premier morceau
+    for (int c = 1; c < num_chunks; c++) {
+        if (started[c]) pthread_join(threads[c], NULL);
+        else worker(&chunks[c]);                 // Création impossible : traitement séquentiel
+    }
+}
+
+// Reconnaît un fichier DIMACS : son premier caractère non blanc est une ligne de commentaire ('c')
+// ou de problème ('p'), alors que le format matriciel commence par le nombre de sommets
+int is_dimacs_file(const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) return 0;
+    int c;
+    do c = fgetc(f); while (c != EOF && IS_BLANK(c));
+    fclose(f);
+    return c == 'c' || c == 'p';
+}
+
+// Lit un fichier DIMACS "p max" (lignes n id s|t et a u v cap) ou "p min" (lignes n id offre
+// et a u v borne_inf cap coût). Les sommets sont numérotés à partir de 1 dans le fichier et de 0
+// dans G. S'il y a plusieurs sommets d'offre ou de demande, une super-source (indice n) et un
+// super-puits (indice n+1) les relient ; G->demand reçoit alors la somme des offres.
+// Les bornes inférieures non nulles ne sont pas prises en charge. Retourne 1 en cas de succès.
+static int read_dimacs_file(const char *filename, FlowNetwork *G) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        fprintf(stderr, "Impossible d'ouvrir le fichier %s. Vérifiez le nom et réessayez.\n", filename);
+        return 0;
+    }
+    char line[1024];
+    char kind[8] = "";
+    long n = 0, m = 0, line_no = 0;
+    int num_edges = 0, capacity_edges = 0;
+    int *tail = NULL, *head = NULL;
+    flow_cap_t *cap = NULL;
+    flow_cost_t *cost = NULL;
+    long long *supply = NULL;                     // Offre (> 0) ou demande (< 0) de chaque sommet
+    int s = -1, t = -1;
+    const char *error = NULL;
+
+    while (!error && fgets(line, sizeof(line), f)) {
+        line_no++;
+        char *p = line;
+        while (*p && IS_BLANK(*p)) p++;
+        if (*p == '\0' || *p == 'c') continue;   // Ligne vide ou commentaire
+        if (*p == 'p') {
+            if (kind[0]) { error = "ligne p en double"; break; }
+            if (sscanf(p + 1, "%7s %ld %ld", kind, &n, &m) != 3 || (strcmp(kind, "max") != 0 && strcmp(kind, "min") != 0))
+                error = "ligne p attendue sous la forme 'p max n m' ou 'p min n m'";
+            else if (n <= 0 || n > INT_MAX - 2 || m < 0 || m > INT_MAX / 2 - n)
+                error = "taille du problème invalide";
+            else {
+                capacity_edges = (int)m + 2 * (int)n; // Place pour les arcs de la super-source et du super-puits
+                tail = (int *)malloc(capacity_edges * sizeof(int));
+                head = (int *)malloc(capacity_edges * sizeof(int));
+                cap = (flow_cap_t *)malloc(capacity_edges * sizeof(flow_cap_t));
+                cost = (flow_cost_t *)calloc(capacity_edges, sizeof(flow_cost_t));
+                supply = (long long *)calloc(n, sizeof(long long));
+                if (!tail || !head || !cap || !cost || !supply) error = "mémoire insuffisante";
+            }
+            continue;
+        }
+        if (!kind[0]) { error = "ligne p manquante avant les données"; break; }
+        int is_max = kind[1] == 'a';
+        if (*p == 'n') {                          // Désignation d'un sommet
+            long id;
+            long long value = 0;
+            char role[2] = "";
+            int read = is_max ? sscanf(p + 1, "%ld %1s", &id, role) : sscanf(p + 1, "%ld %lld", &id, &value);
+            if (read != 2) { error = is_max ? "ligne n attendue sous la forme 'n id s' ou 'n id t'" : "ligne n attendue sous la forme 'n id offre'"; break; }
+            if (id < 1 || id > n) { error = "numéro de sommet hors limites"; break; }
+            if (is_max) {
+                if (role[0] == 's') s = (int)(id - 1);
+                else if (role[0] == 't') t = (int)(id - 1);
+                else error = "ligne n attendue sous la forme 'n id s' ou 'n id t'";
+            } else {
+                if (value < -FLOW_CAP_MAX || value > FLOW_CAP_MAX) error = "offre invalide";
+                else supply[id - 1] += value;
+            }
+        } else if (*p == 'a') {                   // Arc
+            long u, v, low = 0;
+            long long c, w = 0;
+            int read = is_max ? sscanf(p + 1, "%ld %ld %lld", &u, &v, &c) : sscanf(p + 1, "%ld %ld %ld %lld %lld", &u, &v, &low, &c, &w);
+            if (read != (is_max ? 3 : 5)) { error = is_max ? "ligne a attendue sous la forme 'a u v cap'" : "ligne a attendue sous la forme 'a u v min cap coût'"; break; }
+            if (u < 1 || u > n || v < 1 || v > n) { error = "numéro de sommet hors limites"; break; }
+            if (low != 0) { error = "bornes inférieures non nulles non prises en charge"; break; }
+            if (c > FLOW_CAP_MAX || w < -FLOW_COST_MAX || w > FLOW_COST_MAX) { error = "capacité ou coût trop grand pour FLOW_CAP_BITS / FLOW_COST_BITS"; break; }
+            if (c <= 0 || u == v) continue;       // Arc inutile : aucun flot ne peut y passer
+            if (num_edges >= (int)m) { error = "plus d'arcs que déclaré"; break; }
+            tail[num_edges] = (int)(u - 1);
+            head[num_edges] = (int)(v - 1);
+            cap[num_edges] = (flow_cap_t)c;
+            cost[num_edges] = (flow_cost_t)w;
+            num_edges++;
+        } else {
+            error = "ligne inconnue";
+        }
+    }
+    fclose(f);
+    if (!error && !kind[0]) error = "ligne p manquante";
+
+    int is_max = !error && kind[1] == 'a';
+    int total_nodes = (int)n, demand = 0;
+    if (!error && is_max) {
+        if (s < 0 || t < 0 || s == t) error = "source et puits distincts attendus (lignes n id s et n id t)";
+    } else if (!error) {                          // Offres et demandes du problème de coût minimal
+        long long offer = 0, need = 0;
+        int num_sources = 0, num_sinks = 0;
+        for (int u = 0; u < n; u++) {
+            if (supply[u] > 0) { offer += supply[u]; num_sources++; s = u; }
+            if (supply[u] < 0) { need -= supply[u]; num_sinks++; t = u; }
+        }
+        if (offer != need) error = "offres et demandes non équilibrées";
+        else if (offer > INT_MAX) error = "offre totale trop grande";
+        else if (num_sources == 0) { s = 0; t = (int)n - 1; }   // Rien à faire circuler
+        else if (num_sources > 1 || num_sinks > 1) {            // Super-source n et super-puits n+1
+            total_nodes = (int)n + 2;
+            for (int u = 0; u < n; u++) {
+                if (supply[u] == 0) continue;
+                tail[num_edges] = supply[u] > 0 ? (int)n : u;
+                head[num_edges] = supply[u] > 0 ? u : (int)n + 1;
+                cap[num_edges] = (flow_cap_t)(supply[u] > 0 ? supply[u] : -supply[u]);
+                cost[num_edges] = 0;
+                num_edges++;
+            }
+            s = (int)n;
+            t = (int)n + 1;
+        }
+        demand = (int)offer;
+    }
+
+    int ok = 0;
+    if (error) {
+        fprintf(stderr, "Fichier DIMACS %s invalide (ligne %ld) : %s.\n", filename, line_no, error);
+    } else {
+        G->n = total_nodes;
+        ok = build_csr(G, num_edges, tail, head, cap, is_max ? NULL : cost);
+        if (ok) {
+            G->s = s;
+            G->t = t;
+            G->isMinCost = !is_max;
+            G->demand = demand;
+            G->input_nodes = (int)n;
+        } else {
+            fprintf(stderr, "Mémoire insuffisante pour le fichier %s.\n", filename);
+        }
+    }
+    free(tail);
+    free(head);
+    free(cap);
+    free(cost);
+    free(supply);
+    return ok;
+}
+
+// Écrit une solution au format DIMACS : la valeur (ligne s) puis le flot non nul de chaque arc
+// du fichier d'origine (lignes f u v x, sommets numérotés à partir de 1). arc_flow est rempli
+// par un solveur (voir FlowNetwork.arc_flow). Retourne 1 en cas de succès, 0 sinon.
+int write_dimacs_solution(const char *filename, const FlowNetwork *G, const flow_cap_t *arc_flow, flow_sum_t value) {
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        fprintf(stderr, "Impossible de créer le fichier %s.\n", filename);
+        return 0;
+    }
+    fprintf(f, "c %s\n", G->isMinCost ? "Flot à coût minimal" : "Flot maximal");
+    fprintf(f, "s %lld\n", value);
+    for (int u = 0; u < G->input_nodes; u++) {
+        for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+            int v = G->head[a];
+            if (G->capacity[a] > 0 && arc_flow[a] > 0 && v < G->input_nodes)
+                fprintf(f, "f %d %d %lld\n", u + 1, v + 1, (long long)arc_flow[a]);
+        }
+    }
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Erreur d'écriture dans %s.\n", filename);
+    return ok;
+}
+
+// Fonction pour lire les données du fichier d'entrée dans la structure FlowNetwork.
+// Le fichier contient toujours des matrices n x n, mais seuls les arcs de capacité non nulle
+// sont conservés : aucune matrice n x n n'est allouée. Le texte est analysé en parallèle
+// (voir ParseChunk). Un fichier au format binaire est reconnu à son en-tête et projeté en mémoire,
+// un fichier DIMACS (max ou min) à sa première ligne.
+int read_input_file(const char *filename, FlowNetwork *G) {
+    if (is_binary_file(filename)) {
+        return read_binary_file(filename, G);   // Chargement sans analyse de texte
+    }
+    if (is_dimacs_file(filename)) {
+        return read_dimacs_file(filename, G);   // Liste d'arcs creuse
+    }
+
+    int fd = open(filename, O_RDONLY);          // Ouvre le fichier en lecture
+    if (fd < 0) {                               // Erreur d'ouverture
+        fprintf(stderr, "Impossible d'ouvrir le fichier %s. Vérifiez le nom et réessayez.\n", filename); // Message d'erreur plus clair
+        return 0;                               // Retourne 0 pour indiquer l'échec, ce qui permettra de redemander un nom de fichier
+    }
+    struct stat st;
+    size_t size = (fstat(fd, &st) == 0) ? (size_t)st.st_size : 0;
+    const char *text = (size > 0) ? (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (text == MAP_FAILED) {
+        fprintf(stderr, "Fichier %s invalide : nombre de sommets attendu.\n", filename);
+        return 0;
+    }
+    const char *end = text + size;
+
+    // Lit le nombre de sommets n
+    const char *p = text;
+    while (p < end && IS_BLANK(*p)) p++;
+    long long n = 0;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9' && n <= INT_MAX) { n = n * 10 + (*p++ - '0'); digits++; }
+    if (digits == 0 || n <= 0 || n >= INT_MAX || (p < end && !IS_BLANK(*p))) {
+        fprintf(stderr, "Fichier %s invalide : nombre de sommets attendu.\n", filename);
+        munmap((void *)text, size);
+        return 0;
+    }
+    G->n = (int)n;
+
+    // Découpe le reste du texte en morceaux qui se terminent sur une fin de ligne
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t body = (size_t)(end - p);
+    int num_chunks = (int)(body / PARSE_BYTES_PER_THREAD) + 1;
+    if (num_chunks > cpus) num_chunks = cpus > 0 ? (int)cpus : 1;
+    if (num_chunks > PARSE_MAX_THREADS) num_chunks = PARSE_MAX_THREADS;
+    ParseChunk chunks[PARSE_MAX_THREADS];
+    memset(chunks, 0, sizeof(chunks));
+    const char *cut = p;
+    for (int c = 0; c < num_chunks; c++) {
+        chunks[c].n = G->n;
+        chunks[c].begin = cut;
+        const char *stop = (c == num_chunks - 1) ? end : p + body / num_chunks * (c + 1);
+        if (stop < cut) stop = cut;
+        while (stop < end && *stop != '\n') stop++;   // Frontière de ligne : aucun nombre n'est coupé
+        chunks[c].end = stop;
+        cut = stop;
+    }
+
+    parse_run(chunks, num_chunks, parse_count_tokens);
+    int64_t total_tokens = 0;
+    for (int c = 0; c < num_chunks; c++) {       // Indice global du premier nombre de chaque morceau
+        chunks[c].first_token = total_tokens;
+        total_tokens += chunks[c].num_tokens;
+    }
+    parse_run(chunks, num_chunks, parse_chunk_values);
+
+    // Regroupe les arcs des morceaux dans l'ordre des lignes
+    int64_t nn = (int64_t)G->n * G->n;
+    int num_edges = 0, ok = 1;
+    for (int c = 0; c < num_chunks; c++) {
+        num_edges += chunks[c].num_edges;
+        ok = ok && chunks[c].ok;
+    }
+    int *tail = (int *)malloc((num_edges > 0 ? num_edges : 1) * sizeof(int));
+    int *head = (int *)malloc((num_edges > 0 ? num_edges : 1) * sizeof(int));
+    flow_cap_t *cap = (flow_cap_t *)malloc((num_edges > 0 ? num_edges : 1) * sizeof(flow_cap_t));
+    flow_cost_t *cost = NULL;
+    ok = ok && tail && head && cap;
+    int e = 0;
+    for (int c = 0; c < num_chunks && ok; c++) {
+        if (chunks[c].num_edges == 0) continue;   // Morceau sans capacité positive : tableaux non alloués (NULL)
+        memcpy(tail + e, chunks[c].tail, chunks[c].num_edges * sizeof(int));
+        memcpy(head + e, chunks[c].head, chunks[c].num_edges * sizeof(int));
+        memcpy(cap + e, chunks[c].cap, chunks[c].num_edges * sizeof(flow_cap_t));
+        e += chunks[c].num_edges;
+    }
+
+    // Même détection qu'avant : tout contenu après la matrice des capacités est une matrice de coûts
+    if (total_tokens > nn) {
+        cost = (flow_cost_t *)calloc(num_edges > 0 ? num_edges : 1, sizeof(flow_cost_t)); // Un coût par arc conservé
+        ok = ok && cost;
+        e = 0;
+        for (int c = 0; c < num_chunks && ok; c++) {  // Fusion des coûts (triés par case) avec les arcs
+            for (int k = 0; k < chunks[c].num_costs; k++) {
+                int64_t cell = chunks[c].cost_cell[k];
+                while (e < num_edges && (int64_t)tail[e] * G->n + head[e] < cell) e++;
+                if (e < num_edges && (int64_t)tail[e] * G->n + head[e] == cell)
+                    cost[e] = chunks[c].cost_value[k]; // Associe le coût à l'arc (i,j) correspondant
+            }
+        }
+        G->isMinCost = 1;                          // Indique qu'il s'agit d'un problème de flot à coût min
+    } else {
+        G->isMinCost = 0;                          // Pas de matrice de coûts
+    }
+
+    G->s = 0;                   // Définition de la source s=0
+    G->t = G->n - 1;            // Définition du puits t=n-1
+
+    int too_large = 0;
+    for (int c = 0; c < num_chunks; c++) too_large |= chunks[c].too_large;
+    if (too_large) {
+        fprintf(stderr, "Fichier %s invalide : valeur trop grande pour FLOW_CAP_BITS / FLOW_COST_BITS.\n", filename);
+        ok = 0;
+    } else {
+        if (ok) ok = build_csr(G, num_edges, tail, head, cap, cost); // Construit le graphe résiduel CSR
+        if (!ok) {
+            fprintf(stderr, "Mémoire insuffisante pour le fichier %s.\n", filename);
+        }
+    }
+
+    for (int c = 0; c < num_chunks; c++) {
+        free(chunks[c].tail);
+        free(chunks[c].head);
+        free(chunks[c].cap);
+        free(chunks[c].cost_cell);
+        free(chunks[c].cost_value);
+    }
+    free(tail);
+    free(head);
+    free(cap);
+    free(cost);
+    munmap((void *)text, size); // Libère la projection du fichier
+    return ok;                  // Retourne 1 pour indiquer le succès
+}
+
+// Distances des plus courts chemins de Bellman-Ford : toujours sur 64 bits, car un chemin de n - 1 arcs
+// de coût 32 bits dépasse vite INT_MAX (les noyaux vectoriels de relaxation utilisent des voies de 64 bits)
+typedef long long flow_dist_t;
+#define FLOW_DIST_INF LLONG_MAX
+
+// Traces des solveurs. Les événements des boucles internes (envois, réétiquetages, chemins, tables
+// de distances) sont enregistrés sous forme binaire dans un tampon circulaire propre au thread,
+// puis mis en forme par trace_end() une fois la résolution terminée : aucune entrée-sortie n'a lieu
+// pendant le calcul. Compiler avec -DFLOW_TRACE=0 supprime entièrement ces enregistrements.
+#ifndef FLOW_TRACE
+#define FLOW_TRACE 1
+#endif
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE (1 << 18)   // Nombre d'événements conservés (puissance de 2)
+#endif
+
+
+#define TRACE_EV_PATH    0  // a = flot du chemin (Ford-Fulkerson)
+#define TRACE_EV_PUSH    1  // a = quantité, b = u, c = v
+#define TRACE_EV_RELABEL 2  // a = u, b = nouvelle hauteur
+#define TRACE_EV_PHASE   3  // a = numéro de phase, b = flot bloquant (Dinic)
+#define TRACE_EV_DIST    4  // a = sommet, b = distance, c = 1 si dernier sommet de la table
+#define TRACE_EV_CHAIN   5  // a = flot de la chaîne (flot à coût minimal)
+#define TRACE_EV_SCALE   6  // a = seuil delta, b = flot envoyé pendant la phase (mise à l'échelle des capacités)
+
+typedef struct {
+    int type;
+    long long a, b, c;  // Quantités de flot et distances : sur 64 bits quelle que soit la largeur des capacités
+} TraceEvent;
+
+typedef struct {
+    int level;            // Niveau courant (TRACE_NONE par défaut)
+    TraceEvent *events;   // Tampon circulaire de TRACE_RING_SIZE événements, alloué à la demande
+    long long count;      // Événements enregistrés depuis trace_begin()
+} FlowTrace;
+
+static _Thread_local FlowTrace flow_trace;
+
+#define TRACE_ENABLED(min_level) (flow_trace.level >= (min_level))
+#if FLOW_TRACE
+#define TRACE_HOT(min_level) TRACE_ENABLED(min_level)
+#define TRACE_EVENT(min_level, type, a, b, c) do { if (TRACE_HOT(min_level)) trace_record(type, a, b, c); } while (0)
+#else
+#define TRACE_HOT(min_level) 0
+#define TRACE_EVENT(min_level, type, a, b, c) ((void)0)
+#endif
+
+// Compteurs de la résolution en cours (voir FlowStats), propres au thread qui la mène. Les threads auxiliaires
+// (parcours en largeur, Pousser-Réétiqueter parallèle) comptent à part et le thread appelant fait la somme.
+#ifndef FLOW_STATS
+#define FLOW_STATS 1
+#endif
+static _Thread_local FlowStats flow_stats;
+
+const char *const flow_stat_names[FLOW_STAT_COUNT] = {
+    "augmentations", "bfs_runs", "arcs_scanned", "pushes_saturating", "pushes_nonsaturating",
+    "relabels", "global_relabels", "bellman_ford_passes", "pivots"
+};
+
+#if FLOW_STATS
+#define STAT_ADD(index, k) (flow_stats.count[index] += (k))
+#define STAT_LOCAL(var, k) ((var) += (k))   // Compteur local d'un thread auxiliaire
+#else
+#define STAT_ADD(index, k) ((void)0)
+#define STAT_LOCAL(var, k) ((void)(var))
+#endif
+
+// Change le niveau de trace du thread courant ; TRACE_NONE libère le tampon
+void trace_set_level(int level) {
+    flow_trace.level = level;
+    if (level < TRACE_PATHS) {
+        free(flow_trace.events);
+        flow_trace.events = NULL;
+    }
+}
+
+static inline void trace_record(int type, long long a, long long b, long long c) {
+    if (!flow_trace.events) return;   // Allocation refusée : on renonce à la trace
+    TraceEvent *e = &flow_trace.events[flow_trace.count & (TRACE_RING_SIZE - 1)];
+    e->type = type;
+    e->a = a;
+    e->b = b;
+    e->c = c;
+    flow_trace.count++;
+}
+
+// Début d'une résolution : vide le tampon (et l'alloue si le niveau demande des événements)
+static void trace_begin(void) {
+    flow_trace.count = 0;
+    if (FLOW_TRACE && TRACE_ENABLED(TRACE_PATHS) && !flow_trace.events)
+        flow_trace.events = (TraceEvent *)malloc(TRACE_RING_SIZE * sizeof(TraceEvent));
+}
+
+// Fin d'une résolution : met en forme les événements enregistrés, dans l'ordre
+static void trace_end(void) {
+    if (!flow_trace.events || flow_trace.count == 0) return;
+    long long start = 0;
+    if (flow_trace.count > TRACE_RING_SIZE) {
+        start = flow_trace.count - TRACE_RING_SIZE;
+        printf("... %lld événements plus anciens perdus (tampon circulaire plein)\n", start);
+    }
+    for (long long k = start; k < flow_trace.count; k++) {
+        const TraceEvent *e = &flow_trace.events[k & (TRACE_RING_SIZE - 1)];
+        switch (e->type) {
+        case TRACE_EV_PATH:
+            printf("Chemin augmentant trouvé avec flot = %lld\n", e->a);
+            break;
+        case TRACE_EV_PUSH:
+            printf("Envoi de %lld unités de flot du sommet %lld vers le sommet %lld\n", e->a, e->b + 1, e->c + 1);
+            break;
+        case TRACE_EV_RELABEL:
+            printf("Réétiquetage du sommet %lld, nouvelle hauteur = %lld\n", e->a + 1, e->b);
+            break;
+        case TRACE_EV_PHASE:
+            printf("Phase %lld de Dinic : flot bloquant = %lld\n", e->a, e->b);
+            break;
+        case TRACE_EV_DIST:
+            if (e->a == 0) printf("Table de Bellman-Ford (dist):\n");
+            if (e->b == FLOW_DIST_INF) printf("  INF");
+            else printf("%5lld", e->b);
+            if (e->c) printf("\n");
+            break;
+        case TRACE_EV_CHAIN:
+            printf("Chaîne augmentante trouvée, flot = %lld\n", e->a);
+            break;
+        case TRACE_EV_SCALE:
+            printf("Phase delta = %lld : flot envoyé = %lld\n", e->a, e->b);
+            break;
+        }
+    }
+    flow_trace.count = 0;
+}
+
+// Noyaux vectoriels des parcours d'arcs. Les arcs sortants d'un sommet sont contigus dans le CSR :
+// la recherche du premier arc admissible, la hauteur minimale des voisins résiduels et la relaxation
+// de Bellman-Ford traitent 8 (AVX2) ou 16 (AVX-512) arcs par itération, les étiquettes des voisins
+// étant lues par gather sous le masque residual > 0. Le jeu d'instructions est choisi au lancement
+// d'après le processeur (simd_set_level peut l'abaisser). Chaque noyau rend exactement le résultat
+// de sa version scalaire, y compris le premier arc en cas d'égalité : les traces ne changent pas.
+// Compiler avec -DFLOW_SIMD=0 ne garde que les versions scalaires.
+enum { SIMD_SCALAR, SIMD_AVX2, SIMD_AVX512 };
+
+typedef struct {
+    int level;      // SIMD_SCALAR, SIMD_AVX2 ou SIMD_AVX512
+    // Premier arc a de [lo, hi) avec residual[a] > 0 et label[head[a]] == want, hi si aucun
+    int (*find_admissible)(const flow_cap_t *residual, const int *head, const int *label, int lo, int hi, int want);
+    // Plus petite hauteur (< mh) des voisins résiduels ; *best reçoit le premier arc qui l'atteint
+    int (*min_height)(const flow_cap_t *residual, const int *head, const int *height, int lo, int hi, int mh, int *best);
+    // Relaxe les arcs [lo, hi) d'un sommet à distance du ; retourne 1 si une distance a baissé
+    int (*relax)(const flow_cap_t *residual, const int *head, const flow_cost_t *cost, flow_dist_t *dist, int *parent_arc, flow_dist_t du, int lo, int hi);
+} ArcKernels;
+
+static int find_admissible_scalar(const flow_cap_t *residual, const int *head, const int *label, int lo, int hi, int want) {
+    for (int a = lo; a < hi; a++)
+        if (residual[a] > 0 && label[head[a]] == want) return a;
+    return hi;
+}
+
+static int min_height_scalar(const flow_cap_t *residual, const int *head, const int *height, int lo, int hi, int mh, int *best) {
+    for (int a = lo; a < hi; a++) {
+        if (residual[a] > 0 && height[head[a]] < mh) {
+            mh = height[head[a]];
+            *best = a;
+        }
+    }
+    return mh;
+}
+
+static int relax_scalar(const flow_cap_t *residual, const int *head, const flow_cost_t *cost, flow_dist_t *dist, int *parent_arc, flow_dist_t du, int lo, int hi) {
+    int updated = 0;
+    for (int a = lo; a < hi; a++) {
+        int v = head[a];
+        if (residual[a] > 0 && du + cost[a] < dist[v]) {
+            dist[v] = du + cost[a];
+            parent_arc[v] = a;
+            updated = 1;
+        }
+    }
+    return updated;
+}
+
+#if FLOW_SIMD
+// Chargements à largeur variable : residual > 0 donne une voie de 32 bits par arc (pleine si l'arc est
+// résiduel) quelle que soit FLOW_CAP_BITS, et les coûts de 16 bits sont étendus sur 32 bits. Avec des
+// capacités de 16 bits, un vecteur de 8 arcs ne lit que 16 octets de residual[].
+__attribute__((target("avx2")))
+static inline __m256i residual_mask_avx2(const flow_cap_t *residual) {
+    const __m256i zero = _mm256_setzero_si256();
+#if FLOW_CAP_BITS == 16
+    return _mm256_cmpgt_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)residual)), zero);
+#elif FLOW_CAP_BITS == 32
+    return _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)residual), zero);
+#else
+    const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);   // Une moitié de chaque voie de 64 bits
+    __m256i lo = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i *)residual), zero);
+    __m256i hi = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i *)(residual + 4)), zero);
+    return _mm256_blend_epi32(_mm256_permutevar8x32_epi32(lo, even), _mm256_permutevar8x32_epi32(hi, even), 0xF0);
+#endif
+}
+
+__attribute__((target("avx512f")))
+static inline __mmask16 residual_mask_avx512(const flow_cap_t *residual) {
+    const __m512i zero = _mm512_setzero_si512();
+#if FLOW_CAP_BITS == 16
+    return _mm512_cmpgt_epi32_mask(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)residual)), zero);
+#elif FLOW_CAP_BITS == 32
+    return _mm512_cmpgt_epi32_mask(_mm512_loadu_si512(residual), zero);
+#else
+    return (__mmask16)(_mm512_cmpgt_epi64_mask(_mm512_loadu_si512(residual), zero)
+                       | (unsigned)_mm512_cmpgt_epi64_mask(_mm512_loadu_si512(residual + 8), zero) << 8);
+#endif
+}
+
+#if FLOW_COST_BITS < 64
+__attribute__((target("avx2")))
+static inline __m256i cost_load_avx2(const flow_cost_t *cost) {
+#if FLOW_COST_BITS == 16
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)cost));
+#else
+    return _mm256_loadu_si256((const __m256i *)cost);
+#endif
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i cost_load_avx512(const flow_cost_t *cost) {
+#if FLOW_COST_BITS == 16
+    return _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)cost));
+#else
+    return _mm512_loadu_si512(cost);
+#endif
+}
+#endif
+
+__attribute__((target("avx2")))
+static int find_admissible_avx2(const flow_cap_t *residual, const int *head, const int *label, int lo, int hi, int want) {
+    const __m256i vwant = _mm256_set1_epi32(want), other = _mm256_set1_epi32(~want);
+    int a = lo;
+    for (; a + 8 <= hi; a += 8) {
+        __m256i k = residual_mask_avx2(residual + a);
+        if (_mm256_testz_si256(k, k)) continue;                  // Huit arcs saturés : pas de gather
+        __m256i h = _mm256_mask_i32gather_epi32(other, label, _mm256_loadu_si256((const __m256i *)(head + a)), k, 4);
+        int hit = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(h, vwant)));
+        if (hit) return a + __builtin_ctz(hit);
+    }
+    return find_admissible_scalar(residual, head, label, a, hi, want);
+}
+
+__attribute__((target("avx2")))
+static int min_height_avx2(const flow_cap_t *residual, const int *head, const int *height, int lo, int hi, int mh, int *best) {
+    int a = lo;
+    if (hi - lo >= 8) {
+        const __m256i step = _mm256_set1_epi32(8);
+        __m256i vmin = _mm256_set1_epi32(mh), vbest = _mm256_set1_epi32(-1);
+        __m256i vidx = _mm256_add_epi32(_mm256_set1_epi32(lo), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        for (; a + 8 <= hi; a += 8) {
+            __m256i k = residual_mask_avx2(residual + a);
+            __m256i h = _mm256_mask_i32gather_epi32(vmin, height, _mm256_loadu_si256((const __m256i *)(head + a)), k, 4);
+            __m256i upd = _mm256_cmpgt_epi32(vmin, h);           // Strict : chaque voie garde son premier minimum
+            vmin = _mm256_blendv_epi8(vmin, h, upd);
+            vbest = _mm256_blendv_epi8(vbest, vidx, upd);
+            vidx = _mm256_add_epi32(vidx, step);
+        }
+        int mins[8], bests[8], m = mh, b = -1;
+        _mm256_storeu_si256((__m256i *)mins, vmin);
+        _mm256_storeu_si256((__m256i *)bests, vbest);
+        for (int l = 0; l < 8; l++) {                            // Minimum, puis plus petit arc qui l'atteint
+            if (mins[l] < m || (mins[l] == m && b >= 0 && bests[l] < b)) {
+                m = mins[l];
+                b = bests[l];
+            }
+        }
+        if (m < mh) {
+            mh = m;
+            *best = b;
+        }
+    }
+    return min_height_scalar(residual, head, height, a, hi, mh, best);
+}
+
+#if FLOW_COST_BITS < 64
+// Quatre arcs de la relaxation sur des voies de 64 bits : masque, coûts et voisins sont les moitiés des
+// vecteurs de 8 voies de 32 bits. Retourne un bit par arc dont la distance candidate est meilleure.
+__attribute__((target("avx2")))
+static inline int relax_hits_avx2(__m256i vdu, __m128i k, __m128i c, __m128i idx, const flow_dist_t *dist) {
+    __m256i cand = _mm256_add_epi64(vdu, _mm256_cvtepi32_epi64(c));
+    __m256i dv = _mm256_mask_i32gather_epi64(cand, dist, idx, _mm256_cvtepi32_epi64(k), 8);
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(dv, cand)));
+}
+
+__attribute__((target("avx2")))
+static int relax_avx2(const flow_cap_t *residual, const int *head, const flow_cost_t *cost, flow_dist_t *dist, int *parent_arc, flow_dist_t du, int lo, int hi) {
+    const __m256i vdu = _mm256_set1_epi64x(du);
+    int updated = 0, a = lo;
+    for (; a + 8 <= hi; a += 8) {
+        __m256i k = residual_mask_avx2(residual + a);
+        if (_mm256_testz_si256(k, k)) continue;
+        __m256i c = cost_load_avx2(cost + a);
+        __m256i idx = _mm256_loadu_si256((const __m256i *)(head + a));
+        int hit = relax_hits_avx2(vdu, _mm256_castsi256_si128(k), _mm256_castsi256_si128(c), _mm256_castsi256_si128(idx), dist)
+                | relax_hits_avx2(vdu, _mm256_extracti128_si256(k, 1), _mm256_extracti128_si256(c, 1),
+                                  _mm256_extracti128_si256(idx, 1), dist) << 4;
+        while (hit) {           // Candidats dans l'ordre des arcs ; la relecture de dist gère les arcs parallèles
+            int b = a + __builtin_ctz(hit);
+            hit &= hit - 1;
+            if (du + cost[b] < dist[head[b]]) {
+                dist[head[b]] = du + cost[b];
+                parent_arc[head[b]] = b;
+                updated = 1;
+            }
+        }
+    }
+    return relax_scalar(residual, head, cost, dist, parent_arc, du, a, hi) | updated;
+}
+#endif
+
+__attribute__((target("avx512f")))
+static int find_admissible_avx512(const flow_cap_t *residual, const int *head, const int *label, int lo, int hi, int want) {
+    const __m512i vwant = _mm512_set1_epi32(want), other = _mm512_set1_epi32(~want);
+    int a = lo;
+    for (; a + 16 <= hi; a += 16) {
+        __mmask16 k = residual_mask_avx512(residual + a);
+        if (!k) continue;
+        __m512i h = _mm512_mask_i32gather_epi32(other, k, _mm512_loadu_si512(head + a), label, 4);
+        __mmask16 hit = _mm512_mask_cmpeq_epi32_mask(k, h, vwant);
+        if (hit) return a + __builtin_ctz(hit);
+    }
+    return find_admissible_scalar(residual, head, label, a, hi, want);
+}
+
+__attribute__((target("avx512f")))
+static int min_height_avx512(const flow_cap_t *residual, const int *head, const int *height, int lo, int hi, int mh, int *best) {
+    int a = lo;
+    if (hi - lo >= 16) {
+        const __m512i step = _mm512_set1_epi32(16);
+        __m512i vmin = _mm512_set1_epi32(mh), vbest = _mm512_set1_epi32(-1);
+        __m512i vidx = _mm512_add_epi32(_mm512_set1_epi32(lo),
+                                        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        for (; a + 16 <= hi; a += 16) {
+            __mmask16 k = residual_mask_avx512(residual + a);
+            __m512i h = _mm512_mask_i32gather_epi32(vmin, k, _mm512_loadu_si512(head + a), height, 4);
+            __mmask16 upd = _mm512_cmplt_epi32_mask(h, vmin);
+            vmin = _mm512_mask_mov_epi32(vmin, upd, h);
+            vbest = _mm512_mask_mov_epi32(vbest, upd, vidx);
+            vidx = _mm512_add_epi32(vidx, step);
+        }
+        int m = _mm512_reduce_min_epi32(vmin);
+        if (m < mh) {
+            mh = m;
+            *best = _mm512_mask_reduce_min_epi32(_mm512_cmpeq_epi32_mask(vmin, _mm512_set1_epi32(m)), vbest);
+        }
+    }
+    return min_height_scalar(residual, head, height, a, hi, mh, best);
+}
+
+#if FLOW_COST_BITS < 64
+// Huit arcs de la relaxation sur des voies de 64 bits (moitié des 16 voies de 32 bits)
+__attribute__((target("avx512f")))
+static inline unsigned relax_hits_avx512(__m512i vdu, __mmask8 k, __m256i c, __m256i idx, const flow_dist_t *dist) {
+    __m512i cand = _mm512_add_epi64(vdu, _mm512_cvtepi32_epi64(c));
+    __m512i dv = _mm512_mask_i32gather_epi64(cand, k, idx, dist, 8);
+    return _mm512_mask_cmpgt_epi64_mask(k, dv, cand);
+}
+
+__attribute__((target("avx512f")))
+static int relax_avx512(const flow_cap_t *residual, const int *head, const flow_cost_t *cost, flow_dist_t *dist, int *parent_arc, flow_dist_t du, int lo, int hi) {
+    const __m512i vdu = _mm512_set1_epi64(du);
+    int updated = 0, a = lo;
+    for (; a + 16 <= hi; a += 16) {
+        __mmask16 k = residual_mask_avx512(residual + a);
+        if (!k) continue;
+        __m512i c = cost_load_avx512(cost + a);
+        __m512i idx = _mm512_loadu_si512(head + a);
+        unsigned hit = relax_hits_avx512(vdu, (__mmask8)k, _mm512_castsi512_si256(c), _mm512_castsi512_si256(idx), dist)
+                     | relax_hits_avx512(vdu, (__mmask8)(k >> 8), _mm512_extracti64x4_epi64(c, 1),
+                                         _mm512_extracti64x4_epi64(idx, 1), dist) << 8;
+        while (hit) {
+            int b = a + __builtin_ctz(hit);
+            hit &= hit - 1;
+            if (du + cost[b] < dist[head[b]]) {
+                dist[head[b]] = du + cost[b];
+                parent_arc[head[b]] = b;
+                updated = 1;
+            }
+        }
+    }
+    return relax_scalar(residual, head, cost, dist, parent_arc, du, a, hi) | updated;
+}
+#endif
+#endif
+
+#if FLOW_COST_BITS == 64                // Coûts sur 64 bits : la relaxation reste scalaire
+#define relax_avx2 relax_scalar
+#define relax_avx512 relax_scalar
+#endif
+
+static ArcKernels arc_kernels = { SIMD_SCALAR, find_admissible_scalar, min_height_scalar, relax_scalar };
+
+// Choisit les noyaux : level est ramené au meilleur jeu d'instructions disponible. Retourne le niveau retenu.
+int simd_set_level(int level) {
+#if FLOW_SIMD
+    __builtin_cpu_init();
+    if (level >= SIMD_AVX512 && __builtin_cpu_supports("avx512f")) {
+        arc_kernels = (ArcKernels){ SIMD_AVX512, find_admissible_avx512, min_height_avx512, relax_avx512 };
+        return SIMD_AVX512;
+    }
+    if (level >= SIMD_AVX2 && __builtin_cpu_supports("avx2")) {
+        arc_kernels = (ArcKernels){ SIMD_AVX2, find_admissible_avx2, min_height_avx2, relax_avx2 };
+        return SIMD_AVX2;
+    }
+#endif
+    (void)level;
+    arc_kernels = (ArcKernels){ SIMD_SCALAR, find_admissible_scalar, min_height_scalar, relax_scalar };
+    return SIMD_SCALAR;
+}
+
+#if FLOW_SIMD
+__attribute__((constructor)) static void simd_init(void) {  // Avant main : le meilleur jeu disponible
+    simd_set_level(SIMD_AVX512);
+}
+#endif
+
+// Index des arcs résiduels : out[] a le bit a quand residual[a] >= threshold, in[] le bit a quand
+// residual[rev[a]] >= threshold (l'arc entrant apparié est utilisable). Les solveurs le mettent à jour à chaque
+// modification de residual (augmentation, envoi) ; les parcours en largeur sautent alors les arcs saturés
+// 64 par 64 au lieu de lire residual[] case par case. Les arcs sont parcourus dans le même ordre, le résultat
+// ne change pas. Avec threshold = 1, ce sont les arcs résiduels ; un seuil plus grand restreint les parcours
+// aux arcs de grande capacité résiduelle (mise à l'échelle des capacités).
+typedef struct {
+    uint64_t *out;      // Bit a : residual[a] >= threshold
+    uint64_t *in;       // Bit a : residual[rev[a]] >= threshold
+    int words;          // Mots de 64 bits de chaque bitset
+    flow_cap_t threshold; // Capacité résiduelle minimale d'un arc utilisable (au moins 1)
+} ResidualIndex;
+
+// Remplit l'index pour le seuil threshold ; out et in sont fournis par l'appelant, (m + 63) / 64 mots chacun
+static void residual_index_init(ResidualIndex *R, const FlowNetwork *G, const flow_cap_t *residual, flow_cap_t threshold,
+                                uint64_t *out, uint64_t *in) {
+    R->words = (G->m + 63) / 64;
+    R->out = out;
+    R->in = in;
+    R->threshold = threshold;
+    memset(out, 0, R->words * sizeof(uint64_t));
+    memset(in, 0, R->words * sizeof(uint64_t));
+    for (int a = 0; a < G->m; a++) {
+        if (residual[a] >= threshold) {
+            R->out[a >> 6] |= 1ULL << (a & 63);
+            R->in[G->rev[a] >> 6] |= 1ULL << (G->rev[a] & 63);
+        }
+    }
+}
+
+// Recalcule les bits de l'arc a après une modification de residual[a]
+static inline void residual_index_update(ResidualIndex *R, const FlowNetwork *G, const flow_cap_t *residual, int a) {
+    uint64_t bit = 1ULL << (a & 63), rbit = 1ULL << (G->rev[a] & 63);
+    if (residual[a] >= R->threshold) {
+        R->out[a >> 6] |= bit;
+        R->in[G->rev[a] >> 6] |= rbit;
+    } else {
+        R->out[a >> 6] &= ~bit;
+        R->in[G->rev[a] >> 6] &= ~rbit;
+    }
+}
+
+// Parcours en largeur à direction adaptative (Beamer, Asanović, Patterson). Tant que la frontière
+// est petite, le parcours est descendant : chaque sommet de la frontière examine ses arcs. Quand
+// les arcs de la frontière dépassent une fraction de ceux des sommets non visités, il devient
+// ascendant : chaque sommet non visité cherche un parent dans la frontière (bitmap) et s'arrête au
+// premier trouvé, ce qui évite de parcourir tous les arcs des graphes denses. Chaque niveau est
+// réparti entre les threads d'un groupe créé une fois par espace de travail.
+// Les sommets visités sont rangés dans queue[] niveau par niveau (ordre de découverte) ;
+// en descendant séquentiel, l'ordre et les parents sont ceux d'une BFS classique à file.
+#define DOBFS_ALPHA 14          // Passage en ascendant : arcs de la frontière > arcs non visités / ALPHA
+#define DOBFS_BETA 24           // Retour en descendant : frontière < n / BETA sommets
+#define DOBFS_MIN_VERTICES 256  // En dessous, descendant uniquement (ordre et parents de la BFS classique)
+#define DOBFS_MAX_THREADS 64
+#define DOBFS_BATCH 256         // Sommets accumulés par un thread avant réservation dans queue[]
+
+struct BFSWorkspace;
+
+typedef struct {
+    struct BFSWorkspace *W;
+    int id;
+} BFSWorker;
+
+typedef struct BFSWorkspace {
+    const FlowNetwork *G;
+    int words;                  // Mots de 64 bits des bitmaps
+    uint64_t *visited;          // Sommets déjà atteints
+    uint64_t *frontier_bits;    // Frontière courante (parcours ascendant)
+    int *queue;                 // Sommets visités, niveau par niveau
+    int count;                  // Taille utile de queue[] (après l'appel : sommets atteints)
+    // Requête en cours
+    const flow_cap_t *residual;
+    const ResidualIndex *index; // Index des arcs résiduels tenu par l'appelant, NULL sinon
+    int *parent_arc, *dist;
+    int reverse, target, excluded, found, level;
+    int level_begin, level_end; // Frontière courante = queue[level_begin .. level_end)
+    long next_edges;            // Somme des degrés des sommets découverts au niveau courant
+    long scanned;               // Arcs examinés par tous les threads pendant le parcours (FlowStats)
+    // Groupe de threads : le thread appelant est le thread 0
+    int num_threads;
+    pthread_t threads[DOBFS_MAX_THREADS];
+    BFSWorker workers[DOBFS_MAX_THREADS];
+    pthread_mutex_t gate;
+    pthread_barrier_t start, done;
+    void (*task)(struct BFSWorkspace *W, int id);
+    int quit;
+} BFSWorkspace;
+
+static int bfs_default_threads = 1;  // Threads des parcours de ford_fulkerson et du réétiquetage global
+
+// Règle le nombre de threads des parcours en largeur (0 = un par cœur)
+void bfs_set_threads(int num_threads) {
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    bfs_default_threads = num_threads < DOBFS_MAX_THREADS ? num_threads : DOBFS_MAX_THREADS;
+}
+
+static void *bfs_pool_worker(void *arg) {
+    BFSWorker *self = (BFSWorker *)arg;
+    BFSWorkspace *W = self->W;
+    pthread_mutex_lock(&W->gate);     // Attend que les barrières soient dimensionnées
+    pthread_mutex_unlock(&W->gate);
+    while (1) {
+        pthread_barrier_wait(&W->start);
+        if (W->quit) break;
+        W->task(W, self->id);
+        pthread_barrier_wait(&W->done);
+    }
+    return NULL;
+}
+
+// Exécute task sur tous les threads du groupe et attend qu'ils aient fini
+static void bfs_pool_run(BFSWorkspace *W, void (*task)(BFSWorkspace *W, int id)) {
+    if (W->num_threads == 1) {
+        task(W, 0);
+        return;
+    }
+    W->task = task;
+    pthread_barrier_wait(&W->start);
+    task(W, 0);
+    pthread_barrier_wait(&W->done);
+}
+
+// Prépare un espace de travail pour G avec num_threads threads (0 = réglage de bfs_set_threads)
+static void bfs_workspace_init(BFSWorkspace *W, const FlowNetwork *G, int num_threads) {
+    int n = G->n;
+    W->G = G;
+    W->words = (n + 63) / 64;
+    W->visited = (uint64_t *)calloc(W->words, sizeof(uint64_t));
+    W->frontier_bits = (uint64_t *)calloc(W->words, sizeof(uint64_t));
+    W->queue = (int *)malloc(n * sizeof(int));
+    W->count = 0;
+    W->index = NULL;
+    if (num_threads <= 0) num_threads = bfs_default_threads;
+    if (num_threads > DOBFS_MAX_THREADS) num_threads = DOBFS_MAX_THREADS;
+    if (num_threads > W->words) num_threads = W->words;   // Au moins un mot de bitmap par thread
+    if (n < DOBFS_MIN_VERTICES) num_threads = 1;          // Petit graphe : BFS classique, séquentielle
+    if (num_threads < 1) num_threads = 1;
+    W->quit = 0;
+    W->num_threads = 1;
+    if (num_threads > 1) {
+        // Les barrières sont dimensionnées après coup, sur le nombre de threads réellement créés
+        pthread_mutex_init(&W->gate, NULL);
+        pthread_mutex_lock(&W->gate);
+        int started = 1;
+        for (int k = 1; k < num_threads; k++) {
+            W->workers[k].W = W;
+            W->workers[k].id = k;
+            if (pthread_create(&W->threads[k], NULL, bfs_pool_worker, &W->workers[k]) != 0) {
+                fprintf(stderr, "Parcours en largeur : %d thread(s) sur %d créés.\n", started, num_threads);
+                break;
+            }
+            started++;
+        }
+        W->num_threads = started;
+        pthread_barrier_init(&W->start, NULL, started);
+        pthread_barrier_init(&W->done, NULL, started);
+        pthread_mutex_unlock(&W->gate);
+        if (started == 1) {
+            pthread_barrier_destroy(&W->start);
+            pthread_barrier_destroy(&W->done);
+            pthread_mutex_destroy(&W->gate);
+        }
+    }
+}
+
+static void bfs_workspace_free(BFSWorkspace *W) {
+    if (W->num_threads > 1) {
+        W->quit = 1;
+        pthread_barrier_wait(&W->start);
+        for (int k = 1; k < W->num_threads; k++) pthread_join(W->threads[k], NULL);
+        pthread_barrier_destroy(&W->start);
+        pthread_barrier_destroy(&W->done);
+        pthread_mutex_destroy(&W->gate);
+    }
+    free(W->visited);
+    free(W->frontier_bits);
+    free(W->queue);
+}
+
+// Ajoute les sommets découverts par un thread à la fin de queue[] (réservation atomique)
+static void bfs_flush(BFSWorkspace *W, const int *batch, int k) {
+    if (k == 0) return;
+    int pos = __atomic_fetch_add(&W->count, k, __ATOMIC_RELAXED);
+    memcpy(W->queue + pos, batch, k * sizeof(int));
+}
+
+// Étape descendante : chaque thread parcourt une tranche de la frontière et réclame les voisins
+// non visités (un fetch_or sur le bitmap départage les threads)
+static void bfs_top_down_task(BFSWorkspace *W, int id) {
+    const int *first = W->G->first, *head = W->G->head, *rev = W->G->rev;
+    const flow_cap_t *residual = W->residual;
+    uint64_t *visited = W->visited;
+    int *parent_arc = W->parent_arc, *dist = W->dist;
+    int reverse = W->reverse, target = W->target, next_level = W->level + 1;
+    const uint64_t *usable = W->index ? (reverse ? W->index->in : W->index->out) : NULL; // Arcs à suivre
+    int size = W->level_end - W->level_begin;
+    int lo = W->level_begin + (int)((long)size * id / W->num_threads);
+    int hi = W->level_begin + (int)((long)size * (id + 1) / W->num_threads);
+    int batch[DOBFS_BATCH], k = 0;
+    long edges = 0, scanned = 0;
+
+    // Examine l'arc a (u->v), dont on sait qu'il est résiduel ; réclame v s'il n'est pas encore visité
+    #define TOP_DOWN_VISIT(a) {                                                                         \
+        int v = head[a];                                                                                \
+        uint64_t bit = 1ULL << (v & 63);                                                                \
+        if (!(__atomic_load_n(&visited[v >> 6], __ATOMIC_RELAXED) & bit)                                \
+            && !(__atomic_fetch_or(&visited[v >> 6], bit, __ATOMIC_RELAXED) & bit)) { /* Sinon pris par un autre thread */ \
+            if (parent_arc) parent_arc[v] = reverse ? rev[a] : (a);                                     \
+            if (dist) dist[v] = next_level;                                                             \
+            edges += first[v + 1] - first[v];                                                           \
+            batch[k++] = v;                                                                             \
+            if (k == DOBFS_BATCH) {                                                                     \
+                bfs_flush(W, batch, k);                                                                 \
+                k = 0;                                                                                  \
+            }                                                                                           \
+            if (v == target) {          /* Puits atteint : le chemin est connu, on arrête */           \
+                __atomic_store_n(&W->found, 1, __ATOMIC_RELAXED);                                       \
+                goto done;                                                                              \
+            }                                                                                           \
+        }                                                                                               \
+    }
+
+    for (int i = lo; i < hi && !__atomic_load_n(&W->found, __ATOMIC_RELAXED); i++) {
+        int u = W->queue[i];
+        int begin = first[u], end = first[u + 1];
+        if (usable) {                       // Index : seuls les arcs résiduels, 64 par mot
+            for (int w = begin >> 6; w << 6 < end; w++) {
+                uint64_t word = usable[w];
+                if (w == begin >> 6) word &= ~0ULL << (begin & 63);
+                while (word) {
+                    int a = (w << 6) + __builtin_ctzll(word);
+                    word &= word - 1;
+                    if (a >= end) break;
+                    STAT_LOCAL(scanned, 1);
+                    TOP_DOWN_VISIT(a);
+                }
+            }
+        } else {
+            for (int a = begin; a < end; a++) {
+                STAT_LOCAL(scanned, 1);
+                if (residual[reverse ? rev[a] : a] <= 0) continue; // En arrière, c'est l'arc v->u qui doit être résiduel
+                TOP_DOWN_VISIT(a);
+            }
+        }
+    }
+    #undef TOP_DOWN_VISIT
+done:
+    bfs_flush(W, batch, k);
+    __atomic_fetch_add(&W->next_edges, edges, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&W->scanned, scanned, __ATOMIC_RELAXED);
+}
+
+// Étape ascendante : chaque thread possède une tranche de mots du bitmap ; chaque sommet non visité
+// cherche un voisin de la frontière et s'arrête au premier trouvé
+static void bfs_bottom_up_task(BFSWorkspace *W, int id) {
+    const FlowNetwork *G = W->G;
+    const flow_cap_t *residual = W->residual;
+    const uint64_t *usable = W->index ? (W->reverse ? W->index->out : W->index->in) : NULL;
+    int w_lo = (int)((long)W->words * id / W->num_threads);
+    int w_hi = (int)((long)W->words * (id + 1) / W->num_threads);
+    int batch[DOBFS_BATCH], k = 0;
+    long edges = 0, scanned = 0;
+    for (int w = w_lo; w < w_hi; w++) {
+        uint64_t todo = ~W->visited[w];         // Seul ce thread écrit ces mots pendant l'étape
+        while (todo) {
+            int u = (w << 6) + __builtin_ctzll(todo);
+            todo &= todo - 1;
+            int parent = -1;                    // Arc résiduel vers u depuis la frontière (x->u en avant)
+            int begin = G->first[u], end = G->first[u + 1];
+            if (usable) {
+                for (int aw = begin >> 6; aw << 6 < end && parent < 0; aw++) {
+                    uint64_t word = usable[aw];
+                    if (aw == begin >> 6) word &= ~0ULL << (begin & 63);
+                    while (word) {
+                        int b = (aw << 6) + __builtin_ctzll(word);
+                        word &= word - 1;
+                        if (b >= end) break;
+                        STAT_LOCAL(scanned, 1);
+                        int x = G->head[b];
+                        if (W->frontier_bits[x >> 6] & (1ULL << (x & 63))) {
+                            parent = W->reverse ? b : G->rev[b];
+                            break;
+                        }
+                    }
+                }
+            } else {
+                for (int b = begin; b < end; b++) {
+                    STAT_LOCAL(scanned, 1);
+                    int x = G->head[b];
+                    if (!(W->frontier_bits[x >> 6] & (1ULL << (x & 63)))) continue;
+                    int arc = W->reverse ? b : G->rev[b]; // En avant, c'est l'arc x->u qui doit être résiduel
+                    if (residual[arc] > 0) {
+                        parent = arc;
+                        break;
+                    }
+                }
+            }
+            if (parent < 0) continue;
+            W->visited[w] |= 1ULL << (u & 63);
+            if (W->parent_arc) W->parent_arc[u] = parent;
+            if (W->dist) W->dist[u] = W->level + 1;
+            edges += end - begin;
+            batch[k++] = u;
+            if (k == DOBFS_BATCH) {
+                bfs_flush(W, batch, k);
+                k = 0;
+            }
+            if (u == W->target) __atomic_store_n(&W->found, 1, __ATOMIC_RELAXED);
+        }
+    }
+    bfs_flush(W, batch, k);
+    __atomic_fetch_add(&W->next_edges, edges, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&W->scanned, scanned, __ATOMIC_RELAXED);
+}
+
+// Parcours en largeur du graphe résiduel depuis source. En avant (reverse = 0), on suit les arcs a
+// tels que residual[a] > 0 et parent_arc[v] est l'arc u->v qui atteint v ; en arrière (reverse = 1),
+// on cherche les sommets qui atteignent source et parent_arc[u] est l'arc u->v emprunté vers source.
+// dist[v] reçoit le niveau de v. parent_arc et dist peuvent être NULL ; les sommets non atteints
+// valent -1. Le sommet excluded (-1 si aucun) n'est jamais visité. Le parcours s'arrête dès que
+// target est atteint (-1 : parcours complet). Retourne 1 si target a été atteint, 0 sinon.
+static int bfs_direction_optimizing(BFSWorkspace *W, const flow_cap_t *residual, int source, int target, int excluded,
+                             int reverse, int *parent_arc, int *dist) {
+    const FlowNetwork *G = W->G;
+    int n = G->n;
+    memset(W->visited, 0, W->words * sizeof(uint64_t));
+    if (n & 63) W->visited[W->words - 1] = ~0ULL << (n & 63);  // Bits au-delà de n : déjà « visités »
+    if (parent_arc) for (int i = 0; i < n; i++) parent_arc[i] = -1;
+    if (dist) for (int i = 0; i < n; i++) dist[i] = -1;
+    W->residual = residual;
+    W->parent_arc = parent_arc;
+    W->dist = dist;
+    W->reverse = reverse;
+    W->target = target;
+    W->excluded = excluded;
+    W->scanned = 0;
+
+    long unexplored = G->m;                     // Arcs des sommets non encore visités
+    if (excluded >= 0 && excluded != source) {
+        W->visited[excluded >> 6] |= 1ULL << (excluded & 63);
+        unexplored -= G->first[excluded + 1] - G->first[excluded];
+    }
+    W->visited[source >> 6] |= 1ULL << (source & 63);
+    if (dist) dist[source] = 0;
+    W->queue[0] = source;
+    W->count = 1;
+    W->level_begin = 0;
+    W->level_end = 1;
+    W->level = 0;
+    W->found = (source == target);
+    long frontier_edges = G->first[source + 1] - G->first[source];
+    unexplored -= frontier_edges;
+
+    int bottom_up = 0;
+    while (W->level_begin < W->level_end && !W->found) {
+        int frontier = W->level_end - W->level_begin;
+        if (bottom_up && frontier < n / DOBFS_BETA)
+            bottom_up = 0;                      // Frontière redevenue petite
+        else if (!bottom_up && n >= DOBFS_MIN_VERTICES && frontier_edges > unexplored / DOBFS_ALPHA)
+            bottom_up = 1;                      // Frontière plus coûteuse que les sommets restants
+
+        W->next_edges = 0;
+        if (bottom_up) {
+            memset(W->frontier_bits, 0, W->words * sizeof(uint64_t));
+            for (int i = W->level_begin; i < W->level_end; i++) {
+                int u = W->queue[i];
+                W->frontier_bits[u >> 6] |= 1ULL << (u & 63);
+            }
+            bfs_pool_run(W, bfs_bottom_up_task);
+        } else {
+            bfs_pool_run(W, bfs_top_down_task);
+        }
+        frontier_edges = W->next_edges;
+        unexplored -= frontier_edges;
+        W->level_begin = W->level_end;
+        W->level_end = W->count;
+        W->level++;
+    }
+    STAT_ADD(FLOW_STAT_BFS_RUNS, 1);
+    STAT_ADD(FLOW_STAT_ARCS_SCANNED, W->scanned);
+    return W->found;
+}
+
+// Réduction du graphe avant résolution. Le graphe réduit garde les mêmes sommets (les numéros des traces
+// et des solutions ne changent pas) mais seulement les arcs qui peuvent porter du flot de s à t :
+//  1. élagage : un sommet non atteint depuis s ou qui n'atteint pas t ne porte aucun flot s -> t ;
+//  2. arcs inutiles : arcs de capacité nulle, boucles, arcs entrant dans s ou sortant de t ;
+//  3. chaînes : un sommet de degré 2 (un seul arc entrant u -> v, un seul sortant v -> w) est court-circuité
+//     par un arc u -> w de capacité minimale et de coût sommé ; une chaîne entière devient un seul arc ;
+//  4. arcs parallèles : les arcs u -> v restants sont fusionnés (capacités sommées), à coût égal seulement
+//     pour le flot à coût minimal. Les arcs antiparallèles restent deux paires distinctes, l'arc inverse
+//     de capacité nulle servant à reconnaître les arcs directs.
+// Chaque arc du graphe réduit regroupe des branches (une par arc fusionné), et chaque branche une chaîne
+// d'arcs du fichier : le flot d'un arc réduit est réparti entre ses branches dans l'ordre, jusqu'à leur
+// capacité, et chaque arc d'une branche reçoit le flot de sa branche. Avec des coûts négatifs, un cycle
+// hors des chemins s -> t peut abaisser le coût : le graphe est alors résolu tel quel.
+struct FlowReduction {
+    FlowNetwork graph;          // Graphe réduit sur lequel travaillent les solveurs
+    flow_cap_t *flow;           // Flot des arcs du graphe réduit (graph.arc_flow pendant une résolution)
+    int num_branches;
+    int *branch_arc;            // Arc direct du graphe réduit qui porte la branche b
+    flow_cap_t *branch_cap;     // Capacité de la branche b : minimum des capacités de sa chaîne
+    flow_cap_t *branch_flow;    // Flot de la branche b lors du développement
+    int *arc_branch;            // Branche de chaque arc du graphe d'origine, -1 si l'arc est supprimé
+};
+
+static int flow_reduction_enabled = 1;
+
+// Active (1) ou désactive (0) la réduction des graphes dans flow_solver_init
+void reduction_set_enabled(int enabled) {
+    flow_reduction_enabled = enabled != 0;
+}
+
+static void flow_reduction_free(FlowReduction *R) {
+    free_flow_network(&R->graph);
+    free(R->flow);
+    free(R->branch_arc);
+    free(R->branch_cap);
+    free(R->branch_flow);
+    free(R->arc_branch);
+    free(R);
+}
+
+// Construit le graphe réduit de G. Retourne NULL si la réduction ne retire rien (G est alors résolu tel
+// quel), s'il a des coûts négatifs ou si la mémoire manque.
+static FlowReduction *flow_reduce(const FlowNetwork *G) {
+    int n = G->n, m = G->m;
+    if (n <= 0 || m <= 0) return NULL;
+    if (G->cost)
+        for (int a = 0; a < m; a++)
+            if (G->capacity[a] > 0 && G->cost[a] < 0) return NULL;
+
+    unsigned char *seen = (unsigned char *)calloc(n, 1);    // Bit 1 : atteint depuis s ; bit 2 : atteint t
+    int *queue = (int *)malloc(n * sizeof(int));
+    int *in_degree = (int *)calloc(n, sizeof(int));         // Arcs utiles entrants et sortants de chaque sommet
+    int *out_degree = (int *)calloc(n, sizeof(int));
+    int *out_arc = (int *)malloc(n * sizeof(int));          // Dernier arc utile sortant (l'unique d'un sommet de chaîne)
+    int *last_edge = (int *)malloc(n * sizeof(int));        // Arc réduit u -> v déjà créé pour le sommet de départ courant
+    int *last_tail = (int *)malloc(n * sizeof(int));
+    int max_edges = m / 2 + 1;
+    int *tail = (int *)malloc(max_edges * sizeof(int));      // Arcs réduits : extrémités, capacité, coût
+    int *head = (int *)malloc(max_edges * sizeof(int));
+    flow_cap_t *cap = (flow_cap_t *)malloc(max_edges * sizeof(flow_cap_t));
+    flow_cost_t *cost = G->cost ? (flow_cost_t *)malloc(max_edges * sizeof(flow_cost_t)) : NULL;
+    int *target = (int *)malloc(max_edges * sizeof(int));    // Arc réduit qui reçoit l'arc e après fusion
+    FlowReduction *R = (FlowReduction *)calloc(1, sizeof(FlowReduction));
+    int *arc_branch = (int *)malloc(m * sizeof(int));
+    flow_cap_t *branch_cap = (flow_cap_t *)malloc(max_edges * sizeof(flow_cap_t));
+    if (!seen || !queue || !in_degree || !out_degree || !out_arc || !last_edge || !last_tail || !tail || !head
+        || !cap || (G->cost && !cost) || !target || !R || !arc_branch || !branch_cap) {
+        free(R); free(arc_branch); free(branch_cap);
+        R = NULL;
+        goto done;
+    }
+
+    // 1. Parcours en avant depuis s et en arrière depuis t (un arc inverse a -> u avec rev[a] direct)
+    int count = 0;
+    queue[count++] = G->s;
+    seen[G->s] |= 1;
+    for (int i = 0; i < count; i++)
+        for (int a = G->first[queue[i]]; a < G->first[queue[i] + 1]; a++)
+            if (G->capacity[a] > 0 && !(seen[G->head[a]] & 1)) {
+                seen[G->head[a]] |= 1;
+                queue[count++] = G->head[a];
+            }
+    count = 0;
+    queue[count++] = G->t;
+    seen[G->t] |= 2;
+    for (int i = 0; i < count; i++)
+        for (int a = G->first[queue[i]]; a < G->first[queue[i] + 1]; a++)
+            if (G->capacity[G->rev[a]] > 0 && !(seen[G->head[a]] & 2)) {
+                seen[G->head[a]] |= 2;
+                queue[count++] = G->head[a];
+            }
+
+    // 2. Arcs utiles : directs, entre deux sommets conservés, ni boucle, ni vers s, ni depuis t
+    #define USEFUL_ARC(u, a) (G->capacity[a] > 0 && seen[u] == 3 && seen[G->head[a]] == 3 \
+                              && G->head[a] != (u) && G->head[a] != G->s && (u) != G->t)
+    int useful = 0, direct = 0;
+    for (int u = 0; u < n; u++)
+        for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+            arc_branch[a] = -1;
+            if (G->capacity[a] > 0) direct++;
+            if (!USEFUL_ARC(u, a)) continue;
+            useful++;
+            out_degree[u]++;
+            in_degree[G->head[a]]++;
+            out_arc[u] = a;
+        }
+    #define CHAIN_VERTEX(v) ((v) != G->s && (v) != G->t && in_degree[v] == 1 && out_degree[v] == 1)
+
+    // 3. Chaque arc utile qui ne part pas d'un sommet de chaîne ouvre une chaîne, suivie jusqu'au premier
+    // sommet qui n'en est pas un (ou jusqu'à ce que le coût sommé dépasse FLOW_COST_MAX). Les arcs réduits
+    // sont créés dans l'ordre des sommets de départ : ceux d'un même sommet sont consécutifs.
+    int num_edges = 0, contracted = 0, merged = 0;
+    for (int u = 0; u < n; u++) {
+        if (CHAIN_VERTEX(u)) continue;
+        for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+            if (!USEFUL_ARC(u, a)) continue;
+            int b = a, from = u;
+            while (1) {
+                int e = num_edges++;
+                flow_cap_t c = G->capacity[b];
+                flow_sum_t k = G->cost ? G->cost[b] : 0;
+                int v = G->head[b];
+                arc_branch[b] = e;
+                while (CHAIN_VERTEX(v)) {                 // Court-circuite v
+                    int next = out_arc[v];
+                    if (G->cost && k + G->cost[next] > FLOW_COST_MAX) break;
+                    if (G->capacity[next] < c) c = G->capacity[next];
+                    if (G->cost) k += G->cost[next];
+                    arc_branch[next] = e;
+                    contracted++;
+                    v = G->head[next];
+                }
+                tail[e] = from;
+                head[e] = v;
+                cap[e] = c;
+                if (cost) cost[e] = (flow_cost_t)k;
+                if (!CHAIN_VERTEX(v)) break;
+                from = v;                                 // Coût saturé : une nouvelle branche repart de v
+                b = out_arc[v];
+            }
+        }
+    }
+
+    // 4. Fusion des arcs parallèles (même départ, même arrivée, même coût). Une chaîne refermée sur son
+    // départ (u -> ... -> u) ne porte pas de flot s -> t et disparaît.
+    for (int v = 0; v < n; v++) last_tail[v] = -1;
+    for (int e = 0; e < num_edges; e++) {
+        int u = tail[e], v = head[e];
+        branch_cap[e] = cap[e];
+        target[e] = e;
+        if (u == v) {
+            target[e] = -1;
+            continue;
+        }
+        int f = last_tail[v] == u ? last_edge[v] : -1;
+        if (f >= 0 && (!cost || cost[f] == cost[e]) && cap[f] <= FLOW_CAP_MAX - cap[e]) {
+            cap[f] += cap[e];
+            target[e] = f;
+            merged++;
+        } else {
+            last_tail[v] = u;
+            last_edge[v] = e;
+        }
+    }
+
+    if (useful == direct && contracted == 0 && merged == 0) {  // Rien à retirer : G est résolu tel quel
+        free(R); free(arc_branch); free(branch_cap);
+        R = NULL;
+        goto done;
+    }
+
+    // Compacte les arcs réduits restants (target[e] = -2 - numéro compacté) et construit le CSR réduit
+    int kept = 0;
+    for (int e = 0; e < num_edges; e++) {
+        if (target[e] != e) continue;
+        tail[kept] = tail[e];
+        head[kept] = head[e];
+        cap[kept] = cap[e];
+        if (cost) cost[kept] = cost[e];
+        target[e] = -2 - kept;
+        kept++;
+    }
+    int *edge_arc = (int *)malloc((kept > 0 ? kept : 1) * sizeof(int));
+    R->graph.n = n;
+    R->branch_arc = (int *)malloc((num_edges > 0 ? num_edges : 1) * sizeof(int));
+    R->branch_flow = (flow_cap_t *)malloc((num_edges > 0 ? num_edges : 1) * sizeof(flow_cap_t));
+    R->flow = (flow_cap_t *)malloc(2 * (kept > 0 ? kept : 1) * sizeof(flow_cap_t));
+    if (!edge_arc || !R->branch_arc || !R->branch_flow || !R->flow
+        || !build_csr_arcs(&R->graph, kept, tail, head, cap, cost, edge_arc)) {
+        free(edge_arc); free(R->branch_arc); free(R->branch_flow); free(R->flow);
+        free(R); free(arc_branch); free(branch_cap);
+        R = NULL;
+        goto done;
+    }
+    for (int e = 0; e < num_edges; e++) {                 // Arc réduit de chaque branche
+        int f = target[e];
+        if (f >= 0) f = target[f];                        // Branche fusionnée : l'arc qui l'a reçue
+        R->branch_arc[e] = f == -1 ? -1 : edge_arc[-2 - f];
+    }
+    free(edge_arc);
+    R->graph.s = G->s;
+    R->graph.t = G->t;
+    R->graph.isMinCost = G->isMinCost;
+    R->graph.demand = G->demand;
+    R->graph.input_nodes = G->input_nodes;
+    R->num_branches = num_edges;
+    R->branch_cap = branch_cap;
+    R->arc_branch = arc_branch;
+    #undef USEFUL_ARC
+    #undef CHAIN_VERTEX
+
+done:
+    free(seen); free(queue); free(in_degree); free(out_degree); free(out_arc);
+    free(last_edge); free(last_tail); free(tail); free(head); free(cap); free(cost); free(target);
+    return R;
+}
+
+// Développe le flot du graphe réduit (R->flow) sur les arcs du graphe d'origine G
+static void flow_reduction_expand(FlowReduction *R, const FlowNetwork *G, flow_cap_t *arc_flow) {
+    for (int b = 0; b < R->num_branches; b++) {
+        int r = R->branch_arc[b];
+        flow_cap_t f = 0;
+        if (r >= 0) {
+            f = R->flow[r] < R->branch_cap[b] ? R->flow[r] : R->branch_cap[b];
+            R->flow[r] -= f;
+        }
+        R->branch_flow[b] = f;
+    }
+    for (int a = 0; a < G->m; a++)
+        arc_flow[a] = R->arc_branch[a] >= 0 ? R->branch_flow[R->arc_branch[a]] : 0;
+}
+
+// Contexte de résolution (voir FlowSolver dans flow.h). L'arène est dimensionnée d'après le graphe pour
+// couvrir les solveurs courants sans allocation ; chaque résolution repart du début de l'arène.
+#define FLOW_ARENA_ALIGN 64             // Chaque tableau commence sur une ligne de cache
+#define FLOW_ARENA_ARC_ARRAYS 2         // Tableaux de m entiers prévus (graphe résiduel, index binaire...)
+#define FLOW_ARENA_VERTEX_ARRAYS 16     // Tableaux de n entiers prévus (hauteurs, excès, files, seaux...)
+
+typedef struct FlowArenaBlock {         // Complément alloué quand l'arène déborde
+    struct FlowArenaBlock *next;
+} FlowArenaBlock;
+
+static size_t arena_round(size_t bytes) {
+    return (bytes + FLOW_ARENA_ALIGN - 1) / FLOW_ARENA_ALIGN * FLOW_ARENA_ALIGN;
+}
+
+// Le graphe est réduit une fois ici (sauf aux traces détaillées, qui décrivent le graphe du fichier) :
+// l'arène est alors dimensionnée pour le graphe réduit.
+int flow_solver_init(FlowSolver *S, FlowNetwork *G) {
+    S->network = G;
+    S->reduction = (flow_reduction_enabled && !TRACE_ENABLED(TRACE_STEPS)) ? flow_reduce(G) : NULL;
+    S->G = S->reduction ? &S->reduction->graph : G;
+    G = S->G;
+    S->arena_size = FLOW_ARENA_ARC_ARRAYS * arena_round((size_t)G->m * sizeof(int))
+                  + FLOW_ARENA_VERTEX_ARRAYS * arena_round((size_t)(G->n + 1) * sizeof(int));
+    S->arena = (unsigned char *)aligned_alloc(FLOW_ARENA_ALIGN, S->arena_size);
+    S->arena_used = 0;
+    S->arena_peak = 0;
+    S->overflow = NULL;
+    S->bfs = NULL;
+    memset(&S->stats, 0, sizeof(S->stats));
+    return S->arena != NULL;
+}
+
+// Début d'une résolution : libère les compléments de la précédente et, si elle a débordé, agrandit
+// l'arène à son besoin total, pour que les résolutions suivantes n'allouent plus rien
+static void solver_begin(FlowSolver *S) {
+    while (S->overflow) {
+        FlowArenaBlock *block = (FlowArenaBlock *)S->overflow;
+        S->overflow = block->next;
+        free(block);
+    }
+    if (S->arena_peak > S->arena_size) {
+        unsigned char *arena = (unsigned char *)aligned_alloc(FLOW_ARENA_ALIGN, S->arena_peak);
+        if (arena) {
+            free(S->arena);
+            S->arena = arena;
+            S->arena_size = S->arena_peak;
+        }
+    }
+    S->arena_used = 0;
+    memset(&flow_stats, 0, sizeof(flow_stats));
+    if (S->reduction)                   // Le flot du graphe réduit est développé par solver_end
+        S->G->arc_flow = S->network->arc_flow ? S->reduction->flow : NULL;
+}
+
+// Fin d'une résolution : range les compteurs et reporte le flot du graphe réduit sur les arcs du fichier
+static void solver_end(FlowSolver *S) {
+    S->stats = flow_stats;
+    if (S->reduction && S->network->arc_flow)
+        flow_reduction_expand(S->reduction, S->network, S->network->arc_flow);
+}
+
+// Réserve bytes octets (alignés sur 64) pour la résolution en cours ; le contenu n'est pas initialisé
+static void *solver_alloc(FlowSolver *S, size_t bytes) {
+    bytes = arena_round(bytes > 0 ? bytes : 1);
+    size_t offset = S->arena_used;
+    S->arena_used += bytes;
+    if (S->arena_used > S->arena_peak) S->arena_peak = S->arena_used;
+    if (S->arena && S->arena_used <= S->arena_size) return S->arena + offset;
+    FlowArenaBlock *block = (FlowArenaBlock *)aligned_alloc(FLOW_ARENA_ALIGN, FLOW_ARENA_ALIGN + bytes);
+    if (!block) {
+        fprintf(stderr, "Mémoire insuffisante pour les tableaux de travail.\n");
+        exit(1);
+    }
+    block->next = (FlowArenaBlock *)S->overflow;
+    S->overflow = block;
+    return (unsigned char *)block + FLOW_ARENA_ALIGN;
+}
+
+static void *solver_calloc(FlowSolver *S, size_t bytes) {
+    return memset(solver_alloc(S, bytes), 0, bytes);
+}
+
+// Parcours en largeur du contexte : bitmaps, file et threads créés une fois (réglage de bfs_set_threads)
+static BFSWorkspace *solver_bfs(FlowSolver *S) {
+    if (!S->bfs) {
+        S->bfs = (BFSWorkspace *)malloc(sizeof(BFSWorkspace));
+        bfs_workspace_init(S->bfs, S->G, 0);
+    }
+    S->bfs->index = NULL;
+    return S->bfs;
+}
+
+void flow_solver_free(FlowSolver *S) {
+    solver_begin(S);                    // Libère les compléments
+    free(S->arena);
+    S->arena = NULL;
+    if (S->bfs) {
+        bfs_workspace_free(S->bfs);
+        free(S->bfs);
+        S->bfs = NULL;
+    }
+    if (S->reduction) {
+        flow_reduction_free(S->reduction);
+        S->reduction = NULL;
+    }
+    S->G = S->network;
+}
+
+// Chemins augmentants successifs (Edmonds-Karp) : tant qu'un parcours en largeur relie s à t par des
+// arcs de l'index R, le chemin trouvé est saturé et R mis à jour. Retourne le flot envoyé.
+static flow_sum_t ff_augment(const FlowNetwork *G, BFSWorkspace *W, ResidualIndex *R, flow_cap_t *residual, int *parent_arc) {
+    flow_sum_t sent = 0;
+    W->index = R;
+    // Tant qu'un chemin augmentant existe
+    while (bfs_direction_optimizing(W, residual, G->s, G->t, -1, 0, parent_arc, NULL)) {
+        flow_cap_t path_flow = FLOW_CAP_MAX;        // Flot possible sur ce chemin
+        for (int v = G->t; v != G->s; v = G->head[G->rev[parent_arc[v]]]) { // Remonte le chemin trouvé
+            int a = parent_arc[v];                  // a est l'arc u->v du chemin
+            if (residual[a] < path_flow)
+                path_flow = residual[a];            // Trouve le minimum résiduel sur le chemin
+        }
+
+        for (int v = G->t; v != G->s; v = G->head[G->rev[parent_arc[v]]]) { // Met à jour le graphe résiduel
+            int a = parent_arc[v];
+            residual[a] -= path_flow;               // Réduit la capacité résiduelle dans le sens u->v
+            residual[G->rev[a]] += path_flow;       // Augmente la résiduelle dans l'autre sens v->u
+            residual_index_update(R, G, residual, a);
+            residual_index_update(R, G, residual, G->rev[a]);
+        }
+
+        TRACE_EVENT(TRACE_PATHS, TRACE_EV_PATH, path_flow, 0, 0); // Trace le flot trouvé sur le chemin
+        STAT_ADD(FLOW_STAT_AUGMENTATIONS, 1);
+        sent += path_flow;                          // Ajoute path_flow au flot envoyé
+    }
+    W->index = NULL;
+    return sent;
+}
+
+// Algorithme Ford-Fulkerson (Edmond-Karp) pour trouver le flot max
+flow_sum_t ford_fulkerson(FlowSolver *S) {
+    FlowNetwork *G = S->G;
+    int n = G->n;                                   // Récupère le nombre de sommets
+    solver_begin(S);
+    flow_cap_t *residual = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t)); // Graphe résiduel (une case par arc)
+    memcpy(residual, G->capacity, G->m * sizeof(flow_cap_t)); // Initialisation du graphe résiduel = capacités
+
+    int *parent_arc = (int *)solver_alloc(S, n * sizeof(int)); // Tableau pour stocker le chemin BFS
+    BFSWorkspace *W = solver_bfs(S);                // Bitmaps, file et threads réutilisés d'un parcours à l'autre
+    ResidualIndex R;                                // Arcs résiduels positifs, tenus à jour à chaque augmentation
+    size_t index_bytes = (size_t)(G->m + 63) / 64 * sizeof(uint64_t);
+    residual_index_init(&R, G, residual, 1, (uint64_t *)solver_alloc(S, index_bytes), (uint64_t *)solver_alloc(S, index_bytes));
+    trace_begin();
+
+    flow_sum_t max_flow = ff_augment(G, W, &R, residual, parent_arc);
+
+    trace_end();            // Affiche la trace après le calcul
+    export_arc_flow(G, residual);
+    solver_end(S);
+    return max_flow;        // Retourne le flot maximal
+}
+
+// Ford-Fulkerson avec mise à l'échelle des capacités : la phase de seuil delta n'augmente que par des arcs
+// de capacité résiduelle >= delta, puis delta est divisé par deux jusqu'à 1 (dernière phase = Edmonds-Karp).
+// delta part de la plus grande puissance de 2 inférieure ou égale à la plus grande capacité sortant de s.
+// Chaque phase envoie au plus 2m chemins, d'où O(m log U) augmentations au lieu d'une par unité de flot
+// dans le pire cas ; les parcours sont ceux de ford_fulkerson, l'index des arcs résiduels portant le seuil.
+flow_sum_t capacity_scaling(FlowSolver *S) {
+    FlowNetwork *G = S->G;
+    solver_begin(S);
+    flow_cap_t *residual = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t));
+    memcpy(residual, G->capacity, G->m * sizeof(flow_cap_t));
+    int *parent_arc = (int *)solver_alloc(S, G->n * sizeof(int));
+    BFSWorkspace *W = solver_bfs(S);
+    size_t index_bytes = (size_t)(G->m + 63) / 64 * sizeof(uint64_t);
+    uint64_t *out = (uint64_t *)solver_alloc(S, index_bytes), *in = (uint64_t *)solver_alloc(S, index_bytes);
+    trace_begin();
+
+    flow_cap_t largest = 0;                         // Aucun chemin ne porte plus que la capacité sortant de s
+    for (int a = G->first[G->s]; a < G->first[G->s + 1]; a++)
+        if (G->capacity[a] > largest) largest = G->capacity[a];
+    flow_cap_t delta = 1;
+    while (delta <= largest / 2) delta *= 2;
+
+    flow_sum_t max_flow = 0;
+    for (; delta >= 1 && largest > 0; delta /= 2) {
+        ResidualIndex R;                            // Arcs de capacité résiduelle >= delta
+        residual_index_init(&R, G, residual, delta, out, in);
+        flow_sum_t phase_flow = ff_augment(G, W, &R, residual, parent_arc);
+        TRACE_EVENT(TRACE_PATHS, TRACE_EV_SCALE, delta, phase_flow, 0); // Trace le flot de la phase
+        max_flow += phase_flow;
+    }
+
+    trace_end();
+    export_arc_flow(G, residual);
+    solver_end(S);
+    return max_flow;
+}
+
+// push_func : fonction pour pousser du flot de u le long de l'arc a dans l'algorithme Push-Relabel
+static void push_func(const FlowNetwork *G, int u, int a, flow_cap_t *residual, flow_sum_t *excess) {
+    int v = G->head[a];
+    flow_cap_t send = (excess[u] < residual[a]) ? (flow_cap_t)excess[u] : residual[a]; // On envoie le min(excess[u],residual[a])
+    residual[a] -= send;         // Réduit la résiduelle u->v
+    residual[G->rev[a]] += send; // Augmente la résiduelle v->u
+    excess[u] -= send;           // Réduit l'excès de u
+    excess[v] += send;           // Augmente l'excès de v
+    STAT_ADD(residual[a] == 0 ? FLOW_STAT_PUSHES_SATURATING : FLOW_STAT_PUSHES_NONSATURATING, 1);
+    TRACE_EVENT(TRACE_STEPS, TRACE_EV_PUSH, send, u, v); // Trace l'action d'envoi
+}
+
+// relabel_func : fonction pour réétiqueter (augmenter la hauteur du sommet u)
+static void relabel_func(const FlowNetwork *G, int u, const flow_cap_t *residual, int *height) {
+    int best;                              // Arc du minimum (inutile ici)
+    // mh = hauteur minimale parmi les voisins reliés à u par un arc résiduel positif
+    int mh = arc_kernels.min_height(residual, G->head, height, G->first[u], G->first[u + 1], INT_MAX, &best);
+    STAT_ADD(FLOW_STAT_RELABELS, 1);
+    STAT_ADD(FLOW_STAT_ARCS_SCANNED, G->first[u + 1] - G->first[u]);
+    if (mh < INT_MAX) {
+        height[u] = mh + 1;                // Augmente la hauteur de u
+        TRACE_EVENT(TRACE_STEPS, TRACE_EV_RELABEL, u, height[u], 0); // Trace l'action de réétiquetage
+    }
+}
+
+// Algorithme pousser-réétiqueter (Push-Relabel) pour le flot max
+flow_sum_t push_relabel(FlowSolver *S) {
+    FlowNetwork *G = S->G;
+    int n = G->n;                                  // Nombre de sommets
+    solver_begin(S);
+
+    flow_cap_t *residual = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t)); // Graphe résiduel
+    memcpy(residual, G->capacity, G->m * sizeof(flow_cap_t)); // Copie des capacités dans residual
+
+    int *height = (int *)solver_calloc(S, n * sizeof(int)); // Tableau des hauteurs, init à 0
+    flow_sum_t *excess = (flow_sum_t *)solver_calloc(S, n * sizeof(flow_sum_t)); // Tableau des excès (64 bits), init à 0
+    trace_begin();
+
+    height[G->s] = n;                              // Hauteur de la source = n
+    for (int a = G->first[G->s]; a < G->first[G->s + 1]; a++) { // Pousse immédiatement depuis la source
+        if (residual[a] > 0) {
+            excess[G->head[a]] += residual[a];     // L'excès du voisin v = la capacité s->v
+            residual[G->rev[a]] += residual[a];    // Résiduel inverse
+            residual[a] = 0;                       // On a poussé tout le flot possible
+        }
+    }
+
+    while (1) {
+        int done = 1;                      // Indicateur si aucune action n'est effectuée
+        for (int u = 0; u < n; u++) {      // Parcourt tous les sommets
+            if (u != G->s && u != G->t && excess[u] > 0) { // Si u a de l'excès (hors s,t)
+                done = 0;                                  // On va tenter quelque chose
+                int end = G->first[u + 1];  // Essaye de pousser vers les voisins admissibles (un niveau plus bas)
+                int a;
+                for (a = arc_kernels.find_admissible(residual, G->head, height, G->first[u], end, height[u] - 1);
+                     a < end && excess[u] > 0;
+                     a = arc_kernels.find_admissible(residual, G->head, height, a + 1, end, height[u] - 1)) {
+                    push_func(G, u, a, residual, excess); // Pousse si admissible
+                }
+                STAT_ADD(FLOW_STAT_ARCS_SCANNED, (a < end ? a + 1 : end) - G->first[u]);
+                if (excess[u] > 0) {        // Si après tentative de push, excès > 0
+                    relabel_func(G, u, residual, height); // On relabel u
+                }
+            }
+        }
+        if (done)                           // Si done = 1, aucune action, on s'arrête
+            break;
+    }
+
+    flow_sum_t max_flow = excess[G->t];     // Le flot max est l'excès au puits
+    trace_end();
+    export_arc_flow(G, residual);
+    solver_end(S);
+    return max_flow;                        // Retourne le flot max
+}
+
+// Paramètres du réétiquetage global : il est relancé dès que le travail de réétiquetage
+// accumulé dépasse HL_GLOBAL_FREQ * (HL_ALPHA * n + m / 2)
+#define HL_ALPHA 6
+#define HL_BETA 12
+#define HL_GLOBAL_FREQ 0.5
+
+// État de la variante "plus haute étiquette" de Pousser-Réétiqueter.
+// Chaque hauteur h < n possède deux seaux : la pile des sommets actifs (excès > 0)
+// et la liste doublement chaînée de tous les sommets de hauteur h (pour l'heuristique du trou).
+typedef struct {
+    const FlowNetwork *G;
+    flow_cap_t *residual; // Capacités résiduelles par arc
+    int *height;        // Hauteur de chaque sommet (n = sommet retiré, il ne peut plus atteindre t)
+    flow_sum_t *excess; // Excès de chaque sommet
+    int *current;       // Arc courant de chaque sommet
+    int *act_head;      // act_head[h] : premier sommet actif de hauteur h (-1 si vide)
+    int *act_next;      // Chaînage des piles de sommets actifs
+    int *all_head;      // all_head[h] : premier sommet de hauteur h (-1 si vide)
+    int *all_next;      // Chaînage avant des listes de hauteur
+    int *all_prev;      // Chaînage arrière des listes de hauteur
+    int *dist;          // Distances au puits calculées par le réétiquetage global
+    BFSWorkspace *bfs;  // Parcours en largeur arrière du réétiquetage global (celui du contexte)
+    int max_active;     // Plus grande hauteur pouvant contenir un sommet actif
+    int max_height;     // Plus grande hauteur non vide
+    int sink;           // Sommet vers lequel on pousse : t en phase 1, s en phase 2 (retour des excès)
+    int excluded;       // Sommet jamais étiqueté : s en phase 1, t en phase 2
+    long pushes, relabels, global_relabels, gaps;
+} HLState;
+
+static void hl_add_all(HLState *S, int u) {  // Ajoute u à la liste de sa hauteur
+    int h = S->height[u];
+    S->all_prev[u] = -1;
+    S->all_next[u] = S->all_head[h];
+    if (S->all_head[h] >= 0) S->all_prev[S->all_head[h]] = u;
+    S->all_head[h] = u;
+    if (h > S->max_height) S->max_height = h;
+}
+
+static void hl_remove_all(HLState *S, int u) {  // Retire u de la liste de sa hauteur
+    int h = S->height[u];
+    if (S->all_prev[u] >= 0) S->all_next[S->all_prev[u]] = S->all_next[u];
+    else S->all_head[h] = S->all_next[u];
+    if (S->all_next[u] >= 0) S->all_prev[S->all_next[u]] = S->all_prev[u];
+}
+
+static void hl_add_active(HLState *S, int u) {  // Empile u parmi les actifs de sa hauteur
+    int h = S->height[u];
+    S->act_next[u] = S->act_head[h];
+    S->act_head[h] = u;
+    if (h > S->max_active) S->max_active = h;
+}
+
+// Réétiquetage global : BFS arrière depuis le puits courant dans le graphe résiduel. La hauteur de chaque
+// sommet devient sa distance exacte au puits ; les sommets qui ne l'atteignent plus sont retirés (hauteur n).
+static void hl_global_relabel(HLState *S) {
+    const FlowNetwork *G = S->G;
+    int n = G->n;
+    for (int h = 0; h < n; h++) {
+        S->act_head[h] = -1;
+        S->all_head[h] = -1;
+    }
+    for (int u = 0; u < n; u++)
+        S->height[u] = n;
+    S->max_active = -1;
+    S->max_height = -1;
+
+    bfs_direction_optimizing(S->bfs, S->residual, S->sink, -1, S->excluded, 1, NULL, S->dist);
+    for (int k = 0; k < S->bfs->count; k++) {   // Sommets atteints, dans l'ordre de la BFS
+        int v = S->bfs->queue[k];
+        S->height[v] = S->dist[v];
+        S->current[v] = G->first[v];
+        hl_add_all(S, v);
+        if (S->excess[v] > 0 && v != S->sink) hl_add_active(S, v);
+    }
+    S->global_relabels++;
+    STAT_ADD(FLOW_STAT_GLOBAL_RELABELS, 1);
+}
+
+// Heuristique du trou : plus aucun sommet n'a la hauteur h, donc tous les sommets
+// plus hauts ne peuvent plus atteindre t et sont retirés.
+static void hl_gap(HLState *S, int h) {
+    int n = S->G->n;
+    for (int k = h + 1; k <= S->max_height; k++) {
+        for (int u = S->all_head[k]; u >= 0; u = S->all_next[u])
+            S->height[u] = n;
+        S->all_head[k] = -1;
+        S->act_head[k] = -1;
+    }
+    S->max_height = h - 1;
+    if (S->max_active > S->max_height) S->max_active = S->max_height;
+    S->gaps++;
+}
+
+// Réétiquette u à partir de son plus bas voisin résiduel. Retourne le travail effectué.
+static long hl_relabel(HLState *S, int u) {
+    const FlowNetwork *G = S->G;
+    int n = G->n;
+    int old = S->height[u];
+    int mh = n;                                // Hauteur minimale parmi les voisins résiduels
+    int best = G->first[u];
+    S->relabels++;
+    STAT_ADD(FLOW_STAT_RELABELS, 1);
+    STAT_ADD(FLOW_STAT_ARCS_SCANNED, G->first[u + 1] - G->first[u]);
+
+    hl_remove_all(S, u);
+    mh = arc_kernels.min_height(S->residual, G->head, S->height, G->first[u], G->first[u + 1], mh, &best);
+    if (mh + 1 < n) {
+        S->height[u] = mh + 1;
+        S->current[u] = best;                  // Le prochain arc admissible est celui du minimum
+        hl_add_all(S, u);
+    } else {
+        S->height[u] = n;                      // u ne peut plus atteindre t
+    }
+    if (S->all_head[old] < 0)                  // Plus personne à la hauteur old : trou
+        hl_gap(S, old);                        // u, plus haut que old, est retiré lui aussi
+    return HL_BETA + (G->first[u + 1] - G->first[u]);
+}
+
+// Décharge u : pousse par l'arc courant tant que c'est possible, réétiquette sinon.
+// Retourne le travail de réétiquetage effectué.
+static long hl_discharge(HLState *S, int u) {
+    const FlowNetwork *G = S->G;
+    int n = G->n;
+    long work = 0;
+    while (S->excess[u] > 0) {
+        int hu = S->height[u];
+        int end = G->first[u + 1];
+        int start = S->current[u];
+        int a;
+        for (a = arc_kernels.find_admissible(S->residual, G->head, S->height, start, end, hu - 1); a < end;
+             a = arc_kernels.find_admissible(S->residual, G->head, S->height, a + 1, end, hu - 1)) {
+            int v = G->head[a];
+            flow_cap_t send = (S->excess[u] < S->residual[a]) ? (flow_cap_t)S->excess[u] : S->residual[a];
+            if (S->excess[v] == 0 && v != S->sink) hl_add_active(S, v); // v devient actif
+            S->residual[a] -= send;
+            S->residual[G->rev[a]] += send;
+            S->excess[u] -= send;
+            S->excess[v] += send;
+            S->pushes++;
+            STAT_ADD(S->residual[a] == 0 ? FLOW_STAT_PUSHES_SATURATING : FLOW_STAT_PUSHES_NONSATURATING, 1);
+            if (S->excess[u] == 0) break;
+        }
+        STAT_ADD(FLOW_STAT_ARCS_SCANNED, (a < end ? a + 1 : end) - start);
+        if (a < end) {             // Excès écoulé : on garde l'arc courant
+            S->current[u] = a;
+            break;
+        }
+        work += hl_relabel(S, u);
+        if (S->height[u] >= n) break;          // u est retiré du calcul du flot max
+    }
+    return work;
+}
+
+// Pousser-Réétiqueter "plus haute étiquette" : les sommets actifs sont rangés par hauteur et le plus
+// haut est déchargé en premier, avec arcs courants, heuristique du trou et réétiquetages globaux
+// périodiques. Seule la première phase (calcul de la coupe minimale) est nécessaire pour la valeur du flot.
+// Boucle principale : décharge toujours le sommet actif le plus haut jusqu'à épuisement
+static void hl_run(HLState *S) {
+    const FlowNetwork *G = S->G;
+    int n = G->n;
+    hl_global_relabel(S);
+
+    long work = 0;
+    long threshold = (long)(HL_GLOBAL_FREQ * (HL_ALPHA * (double)n + G->m / 2));
+    while (S->max_active >= 0) {
+        int u = S->act_head[S->max_active];
+        if (u < 0) {                           // Seau vide : on descend d'une hauteur
+            S->max_active--;
+            continue;
+        }
+        S->act_head[S->max_active] = S->act_next[u];
+        if (S->height[u] >= n) continue;       // Sommet retiré entre-temps
+        work += hl_discharge(S, u);
+        if (work > threshold) {                // Les hauteurs ont trop dérivé : on les recalcule
+            hl_global_relabel(S);
+            work = 0;
+        }
+    }
+}
+
+// Alloue l'état : graphe résiduel = capacités, excès nuls
+// Prépare l'état de la variante plus haute étiquette dans l'arène du contexte (résolution en cours)
+static void hl_alloc(HLState *H, FlowSolver *S) {
+    const FlowNetwork *G = S->G;
+    int n = G->n;
+    H->G = G;
+    H->residual = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t));
+    memcpy(H->residual, G->capacity, G->m * sizeof(flow_cap_t));
+    H->height = (int *)solver_alloc(S, n * sizeof(int));
+    H->excess = (flow_sum_t *)solver_calloc(S, n * sizeof(flow_sum_t));
+    H->current = (int *)solver_alloc(S, n * sizeof(int));
+    H->act_head = (int *)solver_alloc(S, (n + 1) * sizeof(int));
+    H->act_next = (int *)solver_alloc(S, n * sizeof(int));
+    H->all_head = (int *)solver_alloc(S, (n + 1) * sizeof(int));
+    H->all_next = (int *)solver_alloc(S, n * sizeof(int));
+    H->all_prev = (int *)solver_alloc(S, n * sizeof(int));
+    H->dist = (int *)solver_alloc(S, n * sizeof(int));
+    H->bfs = solver_bfs(S);
+    H->pushes = H->relabels = H->global_relabels = H->gaps = 0;
+}
+
+flow_sum_t push_relabel_highest_label(FlowSolver *S) {
+    FlowNetwork *G = S->G;
+    HLState H;
+    solver_begin(S);
+    hl_alloc(&H, S);
+
+    for (int a = G->first[G->s]; a < G->first[G->s + 1]; a++) { // Sature les arcs sortants de s
+        if (H.residual[a] > 0) {
+            H.excess[G->head[a]] += H.residual[a];
+            H.residual[G->rev[a]] += H.residual[a];
+            H.residual[a] = 0;
+        }
+    }
+    H.sink = G->t;                             // Phase 1 : préflot maximal vers t
+    H.excluded = G->s;
+    hl_run(&H);
+
+    flow_sum_t max_flow = H.excess[G->t];      // Le flot max est l'excès au puits
+    if (G->arc_flow) {                         // Phase 2 : les excès restants retournent à s pour obtenir un flot
+        H.sink = G->s;
+        H.excluded = G->t;
+        hl_run(&H);
+        export_arc_flow(G, H.residual);
+    }
+    if (TRACE_ENABLED(TRACE_RESULT))
+        printf("Pousser-Réétiqueter (plus haute étiquette) : %ld envois, %ld réétiquetages, %ld réétiquetages globaux, %ld trous\n",
+           H.pushes, H.relabels, H.global_relabels, H.gaps);
+    solver_end(S);
+    return max_flow;
+}
+
+// Pousser-Réétiqueter parallèle (variante sans verrou de Hong) : chaque thread décharge des sommets
+// actifs distincts. Un sommet pousse vers son voisin résiduel le plus bas s'il est plus haut que lui,
+// sinon il se réétiquette juste au-dessus ; les capacités résiduelles et les excès ne sont modifiés
+// que par des opérations atomiques. Un indicateur par sommet garantit qu'un seul thread le décharge
+// à la fois. Régulièrement (et à la fin), tous les threads s'arrêtent pour un réétiquetage global
+// parallèle (BFS arrière depuis t niveau par niveau) qui remet des hauteurs exactes : le calcul
+// s'arrête quand, après ce réétiquetage, plus aucun sommet excédentaire n'atteint t.
+#define PPR_MAX_THREADS 256
+
+// File de sommets actifs d'un thread (pile protégée par un verrou, les autres threads peuvent y voler)
+typedef struct {
+    pthread_mutex_t lock;
+    int *items;
+    int count;
+} PPRQueue;
+
+typedef struct {
+    const FlowNetwork *G;
+    flow_cap_t *residual;   // Capacités résiduelles (accès atomiques)
+    int *height;            // Hauteurs (n = sommet retiré)
+    flow_sum_t *excess;     // Excès (accès atomiques)
+    char *queued;           // 1 si le sommet est dans une file ou en cours de décharge
+    int num_threads;
+    PPRQueue *queues;
+    pthread_mutex_t start;  // Tenu pendant la création des threads : la barrière dépend du nombre obtenu
+    pthread_barrier_t barrier;
+    int active;             // Sommets marqués dans queued[]
+    int stop;               // 1 : le travail a dépassé le seuil, réétiquetage global demandé
+    long work;              // Travail de réétiquetage depuis le dernier réétiquetage global
+    long threshold;
+    int *frontier, *next;   // Niveaux de la BFS du réétiquetage global
+    int frontier_size, next_size, level;
+    FlowStats stats;        // Somme des compteurs des threads (envois, réétiquetages, arcs examinés)
+    long global_relabels;
+} PPRState;
+
+typedef struct {
+    PPRState *P;
+    int id;
+} PPRWorker;
+
+// Marque w comme actif et l'ajoute à la file du thread id, sauf s'il l'est déjà
+static void ppr_activate(PPRState *P, int id, int w) {
+    const FlowNetwork *G = P->G;
+    if (w == G->s || w == G->t) return;
+    if (__atomic_load_n(&P->excess[w], __ATOMIC_RELAXED) <= 0 || __atomic_load_n(&P->height[w], __ATOMIC_RELAXED) >= G->n) return;
+    char expected = 0;
+    if (!__atomic_compare_exchange_n(&P->queued[w], &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) return;
+    __atomic_add_fetch(&P->active, 1, __ATOMIC_ACQ_REL);
+    PPRQueue *Q = &P->queues[id];
+    pthread_mutex_lock(&Q->lock);
+    Q->items[Q->count++] = w;
+    pthread_mutex_unlock(&Q->lock);
+}
+
+// Prend un sommet dans sa file, ou en vole un dans celle d'un autre thread. Retourne -1 si rien.
+static int ppr_take(PPRState *P, int id) {
+    for (int k = 0; k < P->num_threads; k++) {
+        PPRQueue *Q = &P->queues[(id + k) % P->num_threads];
+        int v = -1;
+        pthread_mutex_lock(&Q->lock);
+        if (Q->count > 0) v = Q->items[--Q->count];
+        pthread_mutex_unlock(&Q->lock);
+        if (v >= 0) return v;
+    }
+    return -1;
+}
+
+// Décharge v (le thread en est le seul propriétaire tant que queued[v] = 1)
+static void ppr_discharge(PPRState *P, int id, int v, FlowStats *local) {
+    const FlowNetwork *G = P->G;
+    int n = G->n;
+    while (__atomic_load_n(&P->excess[v], __ATOMIC_ACQUIRE) > 0 && P->height[v] < n) {
+        int lowest = n, best = -1;             // Voisin résiduel le plus bas
+        STAT_LOCAL(local->count[FLOW_STAT_ARCS_SCANNED], G->first[v + 1] - G->first[v]);
+        for (int a = G->first[v]; a < G->first[v + 1]; a++) {
+            if (__atomic_load_n(&P->residual[a], __ATOMIC_RELAXED) > 0) {
+                int h = __atomic_load_n(&P->height[G->head[a]], __ATOMIC_RELAXED);
+                if (h < lowest) {
+                    lowest = h;
+                    best = a;
+                }
+            }
+        }
+        if (best >= 0 && P->height[v] > lowest) { // Envoi : seul v diminue residual[best] et son excès
+            flow_sum_t e = __atomic_load_n(&P->excess[v], __ATOMIC_ACQUIRE);
+            flow_cap_t r = __atomic_load_n(&P->residual[best], __ATOMIC_RELAXED);
+            flow_cap_t send = (e < r) ? (flow_cap_t)e : r;
+            int w = G->head[best];
+            __atomic_sub_fetch(&P->residual[best], send, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&P->residual[G->rev[best]], send, __ATOMIC_RELAXED);
+            __atomic_sub_fetch(&P->excess[v], send, __ATOMIC_ACQ_REL);
+            __atomic_add_fetch(&P->excess[w], send, __ATOMIC_ACQ_REL);
+            ppr_activate(P, id, w);
+            local->count[send == r ? FLOW_STAT_PUSHES_SATURATING : FLOW_STAT_PUSHES_NONSATURATING]++;
+        } else {                               // Réétiquetage juste au-dessus du voisin le plus bas
+            __atomic_store_n(&P->height[v], (lowest + 1 < n) ? lowest + 1 : n, __ATOMIC_RELAXED);
+            local->count[FLOW_STAT_RELABELS]++;
+            long w = __atomic_add_fetch(&P->work, HL_BETA + (G->first[v + 1] - G->first[v]), __ATOMIC_RELAXED);
+            if (w > P->threshold) __atomic_store_n(&P->stop, 1, __ATOMIC_RELAXED);
+        }
+    }
+    // Libère v ; s'il a reçu du flot entre-temps, il est repris aussitôt sans changer le compte
+    __atomic_store_n(&P->queued[v], 0, __ATOMIC_RELEASE);
+    char expected = 0;
+    if (__atomic_load_n(&P->excess[v], __ATOMIC_ACQUIRE) > 0 && P->height[v] < n
+        && __atomic_compare_exchange_n(&P->queued[v], &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        PPRQueue *Q = &P->queues[id];
+        pthread_mutex_lock(&Q->lock);
+        Q->items[Q->count++] = v;
+        pthread_mutex_unlock(&Q->lock);
+    } else {
+        __atomic_sub_fetch(&P->active, 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+// Réétiquetage global parallèle : chaque thread traite une part de chaque niveau de la BFS arrière
+static void ppr_global_relabel(PPRState *P, int id, FlowStats *counts) {
+    const FlowNetwork *G = P->G;
+    int n = G->n, T = P->num_threads;
+    int lo = (int)((long)n * id / T), hi = (int)((long)n * (id + 1) / T);
+    for (int u = lo; u < hi; u++) {
+        P->height[u] = n;
+        P->queued[u] = 0;
+    }
+    P->queues[id].count = 0;
+    if (id == 0) {
+        P->active = 0;
+        P->stop = 0;
+        P->work = 0;
+        P->global_relabels++;
+    }
+    pthread_barrier_wait(&P->barrier);
+    if (id == 0) {
+        P->height[G->t] = 0;
+        P->frontier[0] = G->t;
+        P->frontier_size = 1;
+        P->next_size = 0;
+        P->level = 0;
+    }
+    pthread_barrier_wait(&P->barrier);
+
+    int *local = P->queues[id].items;          // File vide : sert de tampon pour le niveau suivant
+    while (P->frontier_size > 0) {
+        int count = 0;
+        int size = P->frontier_size, level = P->level;
+        for (int i = (int)((long)size * id / T); i < (int)((long)size * (id + 1) / T); i++) {
+            int v = P->frontier[i];
+            STAT_LOCAL(counts->count[FLOW_STAT_ARCS_SCANNED], G->first[v + 1] - G->first[v]);
+            for (int a = G->first[v]; a < G->first[v + 1]; a++) {
+                int u = G->head[a];            // L'arc inverse u->v doit avoir une capacité résiduelle
+                int expected = n;
+                if (u != G->s && P->residual[G->rev[a]] > 0 && __atomic_load_n(&P->height[u], __ATOMIC_RELAXED) == n
+                    && __atomic_compare_exchange_n(&P->height[u], &expected, level + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    local[count++] = u;
+            }
+        }
+        int offset = __atomic_fetch_add(&P->next_size, count, __ATOMIC_RELAXED);
+        memcpy(P->next + offset, local, count * sizeof(int));
+        pthread_barrier_wait(&P->barrier);
+        if (id == 0) {                         // Le niveau suivant devient la frontière
+            int *tmp = P->frontier;
+            P->frontier = P->next;
+            P->next = tmp;
+            P->frontier_size = P->next_size;
+            P->next_size = 0;
+            P->level++;
+        }
+        pthread_barrier_wait(&P->barrier);
+    }
+
+    for (int u = lo; u < hi; u++)              // Sommets actifs de sa tranche
+        ppr_activate(P, id, u);
+}
+
+static void *ppr_worker(void *arg) {
+    PPRWorker *self = (PPRWorker *)arg;
+    PPRState *P = self->P;
+    FlowStats local;
+    memset(&local, 0, sizeof(local));
+    pthread_mutex_lock(&P->start);             // Attend que la barrière soit prête
+    pthread_mutex_unlock(&P->start);
+    while (1) {
+        pthread_barrier_wait(&P->barrier);     // Tous les threads ont fini la décharge
+        ppr_global_relabel(P, self->id, &local);
+        pthread_barrier_wait(&P->barrier);
+        if (P->active == 0) break;             // Plus aucun sommet excédentaire n'atteint t : préflot maximal
+        pthread_barrier_wait(&P->barrier);     // Tous ont lu P->active avant que la décharge ne le modifie
+
+        while (__atomic_load_n(&P->active, __ATOMIC_ACQUIRE) > 0 && !__atomic_load_n(&P->stop, __ATOMIC_RELAXED)) {
+            int v = ppr_take(P, self->id);
+            if (v < 0) {
+                sched_yield();                 // Le travail restant est en cours chez les autres threads
+                continue;
+            }
+            ppr_discharge(P, self->id, v, &local);
+        }
+    }
+    for (int k = 0; k < FLOW_STAT_COUNT; k++)
+        __atomic_add_fetch(&P->stats.count[k], local.count[k], __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// Flot max par Pousser-Réétiqueter parallèle sur num_threads threads (0 = un par cœur)
+flow_sum_t push_relabel_parallel(FlowSolver *S, int num_threads) {
+    FlowNetwork *G = S->G;
+    int n = G->n;
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (num_threads > PPR_MAX_THREADS) num_threads = PPR_MAX_THREADS;
+
+    PPRState P;
+    solver_begin(S);
+    P.G = G;
+    P.residual = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t));
+    memcpy(P.residual, G->capacity, G->m * sizeof(flow_cap_t));
+    P.height = (int *)solver_alloc(S, n * sizeof(int));
+    P.excess = (flow_sum_t *)solver_calloc(S, n * sizeof(flow_sum_t));
+    P.queued = (char *)solver_calloc(S, n);
+    P.frontier = (int *)solver_alloc(S, n * sizeof(int));
+    P.next = (int *)solver_alloc(S, n * sizeof(int));
+    P.num_threads = num_threads;
+    P.queues = (PPRQueue *)solver_alloc(S, num_threads * sizeof(PPRQueue));
+    for (int k = 0; k < num_threads; k++) {
+        pthread_mutex_init(&P.queues[k].lock, NULL);
+        P.queues[k].items = (int *)solver_alloc(S, n * sizeof(int)); // Un sommet n'est que dans une file à la fois
+        P.queues[k].count = 0;
+    }
+    pthread_mutex_init(&P.start, NULL);
+    P.threshold = (long)(HL_GLOBAL_FREQ * (HL_ALPHA * (double)n + G->m / 2));
+    memset(&P.stats, 0, sizeof(P.stats));
+    P.global_relabels = 0;
+
+    for (int a = G->first[G->s]; a < G->first[G->s + 1]; a++) { // Sature les arcs sortants de s
+        if (P.residual[a] > 0) {
+            P.excess[G->head[a]] += P.residual[a];
+            P.residual[G->rev[a]] += P.residual[a];
+            P.residual[a] = 0;
+        }
+    }
+
+    pthread_t threads[PPR_MAX_THREADS];
+    PPRWorker workers[PPR_MAX_THREADS];
+    int started = 1;                           // Le thread appelant est le thread 0
+    for (int k = 0; k < num_threads; k++) {
+        workers[k].P = &P;
+        workers[k].id = k;
+    }
+    pthread_mutex_lock(&P.start);
+    while (started < num_threads && pthread_create(&threads[started], NULL, ppr_worker, &workers[started]) == 0)
+        started++;
+    P.num_threads = started;                   // Si une création échoue, on continue avec les threads obtenus
+    pthread_barrier_init(&P.barrier, NULL, started);
+    pthread_mutex_unlock(&P.start);
+    ppr_worker(&workers[0]);
+    for (int k = 1; k < started; k++)
+        pthread_join(threads[k], NULL);
+    for (int k = 0; k < FLOW_STAT_COUNT; k++)
+        STAT_ADD(k, P.stats.count[k]);
+    STAT_ADD(FLOW_STAT_GLOBAL_RELABELS, P.global_relabels);
+    STAT_ADD(FLOW_STAT_BFS_RUNS, P.global_relabels);    // Un parcours arrière par réétiquetage global
+
+    flow_sum_t max_flow = P.excess[G->t];      // Le flot max est l'excès au puits
+    if (G->arc_flow) {                         // Retour séquentiel des excès à s pour obtenir un flot
+        HLState H;
+        hl_alloc(&H, S);
+        memcpy(H.residual, P.residual, G->m * sizeof(flow_cap_t));
+        memcpy(H.excess, P.excess, n * sizeof(flow_sum_t));
+        H.sink = G->s;
+        H.excluded = G->t;
+        hl_run(&H);
+        export_arc_flow(G, H.residual);
+    }
+    if (TRACE_ENABLED(TRACE_RESULT))
+        printf("Pousser-Réétiqueter parallèle (%d threads) : %ld envois, %ld réétiquetages, %ld réétiquetages globaux\n",
+               P.num_threads, (long)(P.stats.count[FLOW_STAT_PUSHES_SATURATING] + P.stats.count[FLOW_STAT_PUSHES_NONSATURATING]),
+               (long)P.stats.count[FLOW_STAT_RELABELS], P.global_relabels);
+
+    pthread_barrier_destroy(&P.barrier);
+    pthread_mutex_destroy(&P.start);
+    for (int k = 0; k < num_threads; k++)
+        pthread_mutex_destroy(&P.queues[k].lock);
+    solver_end(S);
+    return max_flow;
+}
+
+// BFS de Dinic : calcule le niveau (distance en arcs depuis s) de chaque sommet dans le graphe
+// résiduel. Retourne 1 si le puits est atteint, 0 sinon.
+static int bfs_dinic_levels(const FlowNetwork *G, const flow_cap_t *residual, int *level, int *queue) {
+    for (int i = 0; i < G->n; i++)
+        level[i] = -1;             // Niveau -1 = non atteint
+    level[G->s] = 0;
+    int front = 0, rear = 0;
+    queue[rear++] = G->s;
+    while (front < rear) {
+        int u = queue[front++];
+        STAT_ADD(FLOW_STAT_ARCS_SCANNED, G->first[u + 1] - G->first[u]);
+        for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+            int v = G->head[a];
+            if (level[v] < 0 && residual[a] > 0) {
+                level[v] = level[u] + 1;   // v est un niveau plus loin que u
+                queue[rear++] = v;
+            }
+        }
+    }
+    STAT_ADD(FLOW_STAT_BFS_RUNS, 1);
+    return level[G->t] >= 0;
+}
+
+// Algorithme de Dinic pour le flot max : une BFS construit le graphe de niveaux de chaque phase,
+// puis un parcours en profondeur itératif pousse un flot bloquant. Le pointeur d'arc courant
+// current[u] garantit que chaque arc est abandonné au plus une fois par phase.
+flow_sum_t dinic(FlowSolver *S) {
+    FlowNetwork *G = S->G;
+    int n = G->n;
+    solver_begin(S);
+    flow_cap_t *residual = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t)); // Graphe résiduel
+    memcpy(residual, G->capacity, G->m * sizeof(flow_cap_t)); // Copie des capacités dans residual
+
+    int *level = (int *)solver_alloc(S, n * sizeof(int));   // Niveau de chaque sommet dans la phase courante
+    int *current = (int *)solver_alloc(S, n * sizeof(int)); // Arc courant de chaque sommet
+    int *queue = (int *)solver_alloc(S, n * sizeof(int));   // File de la BFS
+    int *path = (int *)solver_alloc(S, n * sizeof(int));    // Pile des arcs du chemin en cours de construction
+    flow_sum_t max_flow = 0;
+    int phase = 0;
+    trace_begin();
+
+    while (bfs_dinic_levels(G, residual, level, queue)) { // Une phase par graphe de niveaux
+        for (int u = 0; u < n; u++)
+            current[u] = G->first[u];
+        flow_sum_t phase_flow = 0;
+        int depth = 0;                 // Nombre d'arcs dans path
+        int u = G->s;
+
+        while (1) {
+            if (u == G->t) {           // Chemin complet : on pousse le goulot
+                flow_cap_t path_flow = FLOW_CAP_MAX;
+                int cut = 0;           // Position du premier arc saturé
+                for (int k = 0; k < depth; k++) {
+                    if (residual[path[k]] < path_flow) {
+                        path_flow = residual[path[k]];
+                        cut = k;
+                    }
+                }
+                for (int k = 0; k < depth; k++) {
+                    residual[path[k]] -= path_flow;
+                    residual[G->rev[path[k]]] += path_flow;
+                }
+                phase_flow += path_flow;
+                STAT_ADD(FLOW_STAT_AUGMENTATIONS, 1);
+                depth = cut;           // On repart de l'origine de l'arc saturé
+                u = G->head[G->rev[path[cut]]];
+                continue;
+            }
+
+            // Cherche un arc admissible (résiduel, vers le niveau suivant) à partir de l'arc courant
+            int from = current[u];
+            current[u] = arc_kernels.find_admissible(residual, G->head, level, from, G->first[u + 1], level[u] + 1);
+            STAT_ADD(FLOW_STAT_ARCS_SCANNED, (current[u] < G->first[u + 1] ? current[u] + 1 : current[u]) - from);
+            if (current[u] < G->first[u + 1]) {
+                int a = current[u];
+                path[depth++] = a;     // Avance le long de l'arc a
+                u = G->head[a];
+                continue;
+            }
+
+            if (u == G->s) break;      // Plus aucun chemin depuis s : flot bloquant atteint
+            level[u] = -1;             // u est une impasse pour le reste de la phase
+            depth--;                   // Recule d'un arc
+            u = G->head[G->rev[path[depth]]];
+            current[u]++;
+        }
+
+        phase++;
+        TRACE_EVENT(TRACE_PATHS, TRACE_EV_PHASE, phase, phase_flow, 0); // Trace le flot de la phase
+        max_flow += phase_flow;
+    }
+
+    trace_end();
+    export_arc_flow(G, residual);
+    solver_end(S);
+    return max_flow;                   // Retourne le flot max
+}
+
+// Re-résolution incrémentale du flot max : le graphe résiduel et le flot sont conservés d'une résolution
+// à l'autre. Quand quelques capacités changent, une hausse élargit simplement l'arc ; une baisse sous le
+// flot courant laisse un excédent en u et un déficit en v (arc u->v), que l'on répare en déviant
+// l'excédent vers v, puis en renvoyant le reste vers s et en le retirant de t. La recherche de chemins
+// augmentants reprend ensuite depuis ce flot. Les parcours marquent les sommets avec un numéro de
+// passage (pas de remise à zéro en O(n)) : une petite modification ne coûte que les chemins qu'elle touche,
+// plus le dernier parcours qui prouve que le flot est maximal.
+// Retourne l'arc direct u->v de G (de capacité initiale positive), -1 s'il n'existe pas
+int flow_find_arc(const FlowNetwork *G, int u, int v) {
+    if (u < 0 || u >= G->n || v < 0 || v >= G->n) return -1;
+    for (int a = G->first[u]; a < G->first[u + 1]; a++)
+        if (G->head[a] == v && G->capacity[a] > 0) return a;
+    return -1;
+}
+
+// Parcours en largeur du graphe résiduel de from vers to ; retourne 1 si to est atteint
+static int inc_find_path(IncrementalFlow *F, int from, int to) {
+    const FlowNetwork *G = F->G;
+    if (F->stamp == INT_MAX) {                  // Les numéros de passage ont fait le tour
+        memset(F->mark, 0, G->n * sizeof(int));
+        F->stamp = 0;
+    }
+    int stamp = ++F->stamp;
+    int front = 0, rear = 0;
+    F->mark[from] = stamp;
+    F->queue[rear++] = from;
+    while (front < rear) {
+        int u = F->queue[front++];
+        for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+            int v = G->head[a];
+            if (F->residual[a] > 0 && F->mark[v] != stamp) {
+                F->mark[v] = stamp;
+                F->parent_arc[v] = a;
+                if (v == to) return 1;
+                F->queue[rear++] = v;
+            }
+        }
+    }
+    return 0;
+}
+
+// Recopie dans G->arc_flow le flot de l'arc a et de son inverse (comme export_arc_flow, avec les capacités courantes)
+static void inc_sync_arc(IncrementalFlow *F, int a) {
+    const FlowNetwork *G = F->G;
+    if (!G->arc_flow) return;
+    int b = G->rev[a];
+    G->arc_flow[a] = (G->capacity[a] > 0) ? F->capacity[a] - F->residual[a] : 0;
+    G->arc_flow[b] = (G->capacity[b] > 0) ? F->capacity[b] - F->residual[b] : 0;
+}
+
+// Envoie jusqu'à amount unités de from vers to par chemins augmentants ; retourne la quantité envoyée.
+// F->flow (flot net sortant de s) et G->arc_flow ne sont mis à jour que le long des chemins trouvés.
+static flow_sum_t inc_route(IncrementalFlow *F, int from, int to, flow_sum_t amount) {
+    const FlowNetwork *G = F->G;
+    flow_sum_t routed = 0;
+    while (routed < amount && from != to && inc_find_path(F, from, to)) {
+        flow_cap_t path_flow = (amount - routed < FLOW_CAP_MAX) ? (flow_cap_t)(amount - routed) : FLOW_CAP_MAX;
+        for (int v = to; v != from; v = G->head[G->rev[F->parent_arc[v]]])
+            if (F->residual[F->parent_arc[v]] < path_flow) path_flow = F->residual[F->parent_arc[v]];
+        for (int v = to; v != from; v = G->head[G->rev[F->parent_arc[v]]]) {
+            int a = F->parent_arc[v];
+            F->residual[a] -= path_flow;
+            F->residual[G->rev[a]] += path_flow;
+            inc_sync_arc(F, a);
+        }
+        TRACE_EVENT(TRACE_PATHS, TRACE_EV_PATH, path_flow, 0, 0);
+        routed += path_flow;
+    }
+    if (from == G->s) F->flow += routed;      // Un chemin qui traverse s ne change pas son flot net
+    if (to == G->s) F->flow -= routed;
+    return routed;
+}
+
+// Augmente le flot courant jusqu'au maximum
+static void inc_augment(IncrementalFlow *F) {
+    inc_route(F, F->G->s, F->G->t, LLONG_MAX);
+}
+
+// Résout une première fois le flot max de G et garde l'état pour les modifications suivantes.
+// Retourne le flot maximal, -1 si l'allocation échoue.
+flow_sum_t incremental_flow_init(IncrementalFlow *F, const FlowNetwork *G) {
+    int n = G->n;
+    F->G = G;
+    F->capacity = (flow_cap_t *)alloc_arc_array(G->m, sizeof(flow_cap_t));
+    F->residual = (flow_cap_t *)alloc_arc_array(G->m, sizeof(flow_cap_t));
+    F->parent_arc = (int *)malloc(n * sizeof(int));
+    F->mark = (int *)calloc(n, sizeof(int));
+    F->queue = (int *)malloc(n * sizeof(int));
+    F->stamp = 0;
+    F->flow = 0;
+    if (!F->capacity || !F->residual || !F->parent_arc || !F->mark || !F->queue) {
+        free(F->capacity); free(F->residual); free(F->parent_arc); free(F->mark); free(F->queue);
+        F->capacity = F->residual = NULL;
+        F->parent_arc = F->mark = F->queue = NULL;
+        return -1;
+    }
+    memcpy(F->capacity, G->capacity, G->m * sizeof(flow_cap_t));
+    memcpy(F->residual, G->capacity, G->m * sizeof(flow_cap_t));
+    if (G->arc_flow) memset(G->arc_flow, 0, G->m * sizeof(flow_cap_t)); // Seule remise à zéro en O(m)
+    trace_begin();
+    inc_augment(F);
+    trace_end();
+    return F->flow;
+}
+
+// Ajoute deltas[k] à la capacité de l'arc direct arcs[k] (flow_find_arc), pour k < count. Une capacité
+// reste entre 0 et FLOW_CAP_MAX. Le flot est d'abord rendu réalisable, puis augmenté. Retourne le nouveau flot max.
+flow_sum_t incremental_flow_update(IncrementalFlow *F, int count, const int *arcs, const flow_sum_t *deltas) {
+    const FlowNetwork *G = F->G;
+    trace_begin();
+    for (int k = 0; k < count; k++) {
+        int a = arcs[k], b = G->rev[a];
+        flow_cap_t cap = F->capacity[a];
+        if (deltas[k] >= 0) cap = (deltas[k] > FLOW_CAP_MAX - cap) ? FLOW_CAP_MAX : (flow_cap_t)(cap + deltas[k]);
+        else cap = (deltas[k] <= -(flow_sum_t)cap) ? 0 : (flow_cap_t)(cap + deltas[k]);
+        flow_cap_t flow = F->capacity[a] - F->residual[a];   // Flot actuel de l'arc
+        F->capacity[a] = cap;
+        if (flow <= cap) {                            // Hausse, ou baisse encore au-dessus du flot
+            F->residual[a] = cap - flow;
+            continue;
+        }
+        flow_sum_t over = flow - cap;                 // Flot en trop sur u->v
+        int u = G->head[b], v = G->head[a];
+        F->residual[a] = 0;
+        F->residual[b] -= (flow_cap_t)over;
+        inc_sync_arc(F, a);
+        if (u == G->s) F->flow -= over;               // Flot retiré d'un arc qui touche s
+        if (v == G->s) F->flow += over;
+        over -= inc_route(F, u, v, over);             // Dévie l'excédent de u vers v sans perdre de flot
+        // Le reste n'a plus de chemin vers v : il remonte vers s et le déficit de v est repris à t
+        // (la décomposition du flot garantit ces deux chemins ; s et t absorbent un déséquilibre)
+        if (over > 0 && u != G->s) inc_route(F, u, G->s, over);
+        if (over > 0 && v != G->t) inc_route(F, G->t, v, over);
+    }
+    inc_augment(F);
+    trace_end();
+    return F->flow;
+}
+
+void incremental_flow_free(IncrementalFlow *F) {
+    free(F->capacity);
+    free(F->residual);
+    free(F->parent_arc);
+    free(F->mark);
+    free(F->queue);
+}
+
+// Bellman-Ford pour trouver un plus court chemin en coût dans le graphe résiduel.
+// Les coûts des arcs inverses sont les opposés des coûts directs (G->cost). dist (n cases) est
+// fourni par l'appelant et réutilisé d'un chemin à l'autre. Retourne 1 si t est accessible, 0 sinon,
+// et -1 si un cycle de coût négatif est accessible depuis s (parent_arc peut alors boucler).
+static int bellman_ford(const FlowNetwork *G, const flow_cap_t *residual_cap, int s, int t, int *parent_arc, flow_dist_t *dist) {
+    int n = G->n;
+    for (int i = 0; i < n; i++) {
+        dist[i] = FLOW_DIST_INF;    // Distance initiale = infinie
+        parent_arc[i] = -1;         // Pas de parent au début
+    }
+    dist[s] = 0;                     // Distance à la source = 0
+
+    int updated = 0;                 // Arrêt anticipé si une passe ne change rien
+    for (int k = 0; k < n-1; k++) {  // Relaxation n-1 fois
+        updated = 0;
+        for (int u = 0; u < n; u++) {
+            if (dist[u] == FLOW_DIST_INF) continue;
+            // Relâche les arcs résiduels de u (mise à jour de dist et de l'arc parent)
+            updated |= arc_kernels.relax(residual_cap, G->head, G->cost, dist, parent_arc, dist[u], G->first[u], G->first[u + 1]);
+            STAT_ADD(FLOW_STAT_ARCS_SCANNED, G->first[u + 1] - G->first[u]);
+        }
+        STAT_ADD(FLOW_STAT_BELLMAN_FORD_PASSES, 1);
+        if (!updated) break;
+    }
+
+    if (TRACE_HOT(TRACE_STEPS)) {         // Trace les distances trouvées (INF si inaccessible)
+        for (int i = 0; i < n; i++)
+            trace_record(TRACE_EV_DIST, i, dist[i], i == n - 1);
+    }
+
+    if (updated) {                   // Passe n : un arc encore relâchable révèle un cycle négatif
+        for (int u = 0; u < n; u++) {
+            if (dist[u] == FLOW_DIST_INF) continue;
+            for (int a = G->first[u]; a < G->first[u + 1]; a++)
+                if (residual_cap[a] > 0 && dist[u] + G->cost[a] < dist[G->head[a]]) return -1;
+        }
+    }
+
+    int reachable = (dist[t] != FLOW_DIST_INF); // 1 si t est accessible, 0 sinon
+    return reachable;                     // Retourne reachable
+}
+
+// Ajoute amount * cost au coût total *total. Retourne 0 si le produit ou la somme dépasse flow_sum_t :
+// *total est alors saturé (LLONG_MAX ou LLONG_MIN) au lieu de changer de signe.
+static inline int cost_accumulate(flow_sum_t *total, flow_sum_t amount, flow_sum_t cost) {
+    flow_sum_t product;
+    if (__builtin_mul_overflow(amount, cost, &product) || __builtin_add_overflow(*total, product, total)) {
+        *total = ((amount < 0) != (cost < 0)) ? LLONG_MIN : LLONG_MAX;
+        return 0;
+    }
+    return 1;
+}
+
+static void cost_overflow_warning(void) {
+    fprintf(stderr, "Coût total hors de la plage des entiers 64 bits : valeur saturée.\n");
+}
+
+static void negative_cycle_error(void) {
+    fprintf(stderr, "Cycle de coût négatif accessible depuis la source : plus courts chemins successifs impossibles.\n");
+}
+
+// Coût d'un flot donné arc par arc (arcs directs), cumulé avec le même contrôle que les solveurs
+flow_sum_t flow_cost_of(const FlowNetwork *G, const flow_cap_t *arc_flow) {
+    flow_sum_t total = 0;
+    int cost_ok = 1;
+    for (int a = 0; a < G->m; a++)
+        if (G->capacity[a] > 0) cost_ok &= cost_accumulate(&total, arc_flow[a], G->cost[a]);
+    if (!cost_ok) cost_overflow_warning();
+    return total;
+}
+
+// Flot à coût minimal pour un flot donné desired_flow
+flow_sum_t min_cost_flow(FlowSolver *S, flow_sum_t desired_flow) {
+    FlowNetwork *G = S->G;
+    int n = G->n;                                         // Nombre de sommets
+    solver_begin(S);
+    flow_cap_t *residual_cap = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t)); // Graphe résiduel pour les capacités
+    memcpy(residual_cap, G->capacity, G->m * sizeof(flow_cap_t)); // Copie des capacités
+
+    int *parent_arc = (int *)solver_alloc(S, n * sizeof(int)); // Tableau parent pour Bellman-Ford
+    flow_dist_t *dist = (flow_dist_t *)solver_alloc(S, n * sizeof(flow_dist_t)); // Distances de Bellman-Ford
+    flow_sum_t flow = 0;                                   // Flot actuel = 0
+    flow_sum_t cost_total = 0;                             // Coût total = 0 (cumul contrôlé)
+    int cost_ok = 1;
+    trace_begin();
+
+    while (flow < desired_flow) {                          // Tant qu'on n'a pas atteint le flot désiré
+        int found = bellman_ford(G, residual_cap, G->s, G->t, parent_arc, dist);
+        if (found < 0) negative_cycle_error();             // Les arcs parents ne mèneraient pas à s
+        if (found <= 0)
+            break; // Pas de chemin augmentant de coût minimal si Bellman-Ford échoue
+
+        // On peut envoyer au plus (desired_flow - flow)
+        flow_cap_t path_flow = (desired_flow - flow < FLOW_CAP_MAX) ? (flow_cap_t)(desired_flow - flow) : FLOW_CAP_MAX;
+        for (int v = G->t; v != G->s; v = G->head[G->rev[parent_arc[v]]]) { // Trouve le max de flot possible sur ce chemin
+            int a = parent_arc[v];
+            if (residual_cap[a] < path_flow)
+                path_flow = residual_cap[a];               // min sur le chemin
+        }
+
+        for (int v = G->t; v != G->s; v = G->head[G->rev[parent_arc[v]]]) { // Met à jour le graphe résiduel
+            int a = parent_arc[v];
+            residual_cap[a] -= path_flow;                  // Réduit la capacité résiduelle u->v
+            residual_cap[G->rev[a]] += path_flow;          // Augmente la résiduelle v->u
+            cost_ok &= cost_accumulate(&cost_total, path_flow, G->cost[a]); // Ajoute le coût (négatif sur un arc inverse)
+        }
+
+        TRACE_EVENT(TRACE_PATHS, TRACE_EV_CHAIN, path_flow, 0, 0); // Trace le flot sur ce chemin
+        STAT_ADD(FLOW_STAT_AUGMENTATIONS, 1);
+        flow += path_flow;                                  // Met à jour le flot total
+    }
+    trace_end();
+
+    if (TRACE_ENABLED(TRACE_RESULT)) {
+        if (flow < desired_flow) {                          // Si on n'a pas atteint le flot désiré
+            printf("Impossible d'atteindre le flot désiré.\n");
+        } else {
+            printf("Flot atteint = %lld, Coût total = %lld\n", flow, cost_total); // Affiche le flot et le coût total
+        }
+    }
+    if (!cost_ok) cost_overflow_warning();
+
+    export_arc_flow(G, residual_cap);
+    solver_end(S);
+    return 0;                           // Retourne 0
+}
+
+// Tas binaire indexé (clé = distance) utilisé par Dijkstra. pos[v] = position de v dans le tas, -1 sinon.
+typedef struct {
+    int *heap;          // Sommets rangés en tas binaire
+    int *pos;           // Position de chaque sommet dans heap
+    long long *key;     // Distances (tableau partagé avec Dijkstra)
+    int size;           // Nombre de sommets dans le tas
+} MinHeap;
+
+static void heap_swap(MinHeap *H, int i, int j) {
+    int a = H->heap[i], b = H->heap[j];
+    H->heap[i] = b; H->pos[b] = i;
+    H->heap[j] = a; H->pos[a] = j;
+}
+
+static void heap_sift_up(MinHeap *H, int i) {
+    while (i > 0 && H->key[H->heap[(i - 1) / 2]] > H->key[H->heap[i]]) {
+        heap_swap(H, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void heap_sift_down(MinHeap *H, int i) {
+    while (1) {
+        int l = 2 * i + 1, r = l + 1, best = i;
+        if (l < H->size && H->key[H->heap[l]] < H->key[H->heap[best]]) best = l;
+        if (r < H->size && H->key[H->heap[r]] < H->key[H->heap[best]]) best = r;
+        if (best == i) return;
+        heap_swap(H, i, best);
+        i = best;
+    }
+}
+
+static void heap_push_or_decrease(MinHeap *H, int v) {  // Insère v ou remonte v après baisse de sa clé
+    if (H->pos[v] < 0) {
+        H->heap[H->size] = v;
+        H->pos[v] = H->size++;
+    }
+    heap_sift_up(H, H->pos[v]);
+}
+
+static int heap_pop(MinHeap *H) {  // Retire le sommet de plus petite clé
+    int v = H->heap[0];
+    H->pos[v] = -1;
+    if (--H->size > 0) {
+        H->heap[0] = H->heap[H->size];
+        H->pos[H->heap[0]] = 0;
+        heap_sift_down(H, 0);
+    }
+    return v;
+}
+
+// Potentiels initiaux : plus courtes distances depuis s dans le graphe résiduel (Bellman-Ford
+// avec file, une seule fois). Les sommets inaccessibles gardent un potentiel nul. Retourne 0 si un
+// cycle de coût négatif est accessible depuis s : un plus court chemin compterait alors n arcs ou plus.
+static int initial_potentials(FlowSolver *S, const flow_cap_t *residual_cap, long long *pi) {
+    const FlowNetwork *G = S->G;
+    int n = G->n;
+    long long *dist = (long long *)solver_alloc(S, n * sizeof(long long));
+    int *queue = (int *)solver_alloc(S, n * sizeof(int));   // File circulaire
+    char *in_queue = (char *)solver_calloc(S, n);
+    int *length = (int *)solver_calloc(S, n * sizeof(int)); // Arcs du chemin qui donne dist[v]
+    for (int i = 0; i < n; i++)
+        dist[i] = LLONG_MAX;
+    dist[G->s] = 0;
+    int front = 0, count = 0;
+    queue[0] = G->s; count = 1; in_queue[G->s] = 1;
+    while (count > 0) {
+        int u = queue[front];
+        front = (front + 1) % n; count--;
+        in_queue[u] = 0;
+        STAT_ADD(FLOW_STAT_ARCS_SCANNED, G->first[u + 1] - G->first[u]);
+        for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+            int v = G->head[a];
+            if (residual_cap[a] > 0 && dist[u] + G->cost[a] < dist[v]) {
+                dist[v] = dist[u] + G->cost[a];
+                length[v] = length[u] + 1;
+                if (length[v] >= n) return 0;  // Le chemin repasse par un sommet : cycle négatif
+                if (!in_queue[v]) {
+                    queue[(front + count) % n] = v;
+                    count++;
+                    in_queue[v] = 1;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < n; i++)
+        pi[i] = (dist[i] == LLONG_MAX) ? 0 : dist[i];
+    return 1;
+}
+
+// Flot à coût minimal par plus courts chemins successifs : Bellman-Ford n'est lancé qu'une fois
+// pour obtenir les potentiels de Johnson, puis chaque chaîne augmentante est trouvée par Dijkstra
+// (tas binaire) sur les coûts réduits cost[a] + pi[u] - pi[v], qui restent positifs ou nuls.
+// Retourne le flot atteint et place le coût total dans *cost_total.
+flow_sum_t min_cost_flow_dijkstra(FlowSolver *S, flow_sum_t desired_flow, flow_sum_t *cost_total) {
+    FlowNetwork *G = S->G;
+    int n = G->n;
+    solver_begin(S);
+    flow_cap_t *residual_cap = (flow_cap_t *)solver_alloc(S, G->m * sizeof(flow_cap_t)); // Graphe résiduel pour les capacités
+    memcpy(residual_cap, G->capacity, G->m * sizeof(flow_cap_t)); // Copie des capacités
+
+    long long *pi = (long long *)solver_alloc(S, n * sizeof(long long));   // Potentiels
+    long long *dist = (long long *)solver_alloc(S, n * sizeof(long long)); // Distances en coûts réduits
+    int *parent_arc = (int *)solver_alloc(S, n * sizeof(int));
+    char *done = (char *)solver_alloc(S, n);                               // Sommets définitivement traités
+    MinHeap H;
+    H.heap = (int *)solver_alloc(S, n * sizeof(int));
+    H.pos = (int *)solver_alloc(S, n * sizeof(int));
+    H.key = dist;
+
+    int potentials_ok = initial_potentials(S, residual_cap, pi);
+    if (!potentials_ok) negative_cycle_error();
+    trace_begin();
+
+    flow_sum_t flow = 0;
+    int cost_ok = 1;
+    *cost_total = 0;
+    while (potentials_ok && flow < desired_flow) {
+        for (int i = 0; i < n; i++) {
+            dist[i] = LLONG_MAX;
+            parent_arc[i] = -1;
+            H.pos[i] = -1;
+            done[i] = 0;
+        }
+        H.size = 0;
+        dist[G->s] = 0;
+        heap_push_or_decrease(&H, G->s);
+        while (H.size > 0) {
+            int u = heap_pop(&H);
+            done[u] = 1;
+            if (u == G->t) break;          // Les distances restantes sont toutes >= dist[t]
+            STAT_ADD(FLOW_STAT_ARCS_SCANNED, G->first[u + 1] - G->first[u]);
+            for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+                int v = G->head[a];
+                if (residual_cap[a] <= 0 || done[v]) continue;
+                long long d = dist[u] + G->cost[a] + pi[u] - pi[v]; // Coût réduit
+                if (d < dist[v]) {
+                    dist[v] = d;
+                    parent_arc[v] = a;
+                    heap_push_or_decrease(&H, v);
+                }
+            }
+        }
+        if (dist[G->t] == LLONG_MAX)
+            break;                         // Plus de chaîne augmentante
+
+        for (int i = 0; i < n; i++)        // Mise à jour des potentiels : pi += min(dist, dist[t])
+            pi[i] += (done[i] && dist[i] < dist[G->t]) ? dist[i] : dist[G->t];
+
+        flow_cap_t path_flow = (desired_flow - flow < FLOW_CAP_MAX) ? (flow_cap_t)(desired_flow - flow) : FLOW_CAP_MAX;
+        for (int v = G->t; v != G->s; v = G->head[G->rev[parent_arc[v]]]) {
+            int a = parent_arc[v];
+            if (residual_cap[a] < path_flow)
+                path_flow = residual_cap[a];
+        }
+        for (int v = G->t; v != G->s; v = G->head[G->rev[parent_arc[v]]]) {
+            int a = parent_arc[v];
+            residual_cap[a] -= path_flow;
+            residual_cap[G->rev[a]] += path_flow;
+            cost_ok &= cost_accumulate(cost_total, path_flow, G->cost[a]);
+        }
+        TRACE_EVENT(TRACE_PATHS, TRACE_EV_CHAIN, path_flow, 0, 0); // Trace le flot sur ce chemin
+        STAT_ADD(FLOW_STAT_AUGMENTATIONS, 1);
+        flow += path_flow;
+    }
+    trace_end();
+
+    if (TRACE_ENABLED(TRACE_RESULT)) {
+        if (flow < desired_flow) {
+            printf("Impossible d'atteindre le flot désiré.\n");
+        } else {
+            printf("Flot atteint = %lld, Coût total = %lld\n", flow, *cost_total);
+        }
+    }
+    if (!cost_ok) cost_overflow_warning();
+
+    export_arc_flow(G, residual_cap);
+    solver_end(S);
+    return flow;
+}
+
+// États des arcs du simplexe des réseaux : le signe sert directement dans le test de l'arc entrant
+#define NS_STATE_UPPER -1   // Arc hors arbre à sa capacité maximale
+#define NS_STATE_TREE   0   // Arc de l'arbre couvrant (base)
+#define NS_STATE_LOWER  1   // Arc hors arbre à flot nul
+
+// Base du simplexe des réseaux : un arbre couvrant enraciné en un sommet artificiel (indice n).
+// L'arbre est décrit par parent/pred et par l'ordre préfixe thread[] (avec rev_thread[] et la
+// taille des sous-arbres succ_num[]), ce qui permet d'énumérer un sous-arbre sans le parcourir.
+typedef struct {
+    int num_nodes;      // n sommets réels + la racine artificielle
+    int num_arcs;       // Arcs réels puis un arc artificiel par sommet
+    int *source, *target;
+    flow_sum_t *cap, *flow;   // Sur 64 bits : les arcs artificiels portent tout le flot désiré
+    long long *cost;
+    signed char *state;
+    int *parent, *pred; // Parent dans l'arbre et arc qui y mène
+    signed char *up;    // up[u] = 1 si pred[u] est orienté u -> parent[u]
+    int *thread, *rev_thread, *succ_num, *depth;
+    long long *pi;      // Potentiels : cost[e] + pi[source] - pi[target] = 0 sur l'arbre
+    int *seg, *order, *child_head, *child_next; // Tableaux de travail de la mise à jour de l'arbre
+    int *csr_arc;       // Arc du graphe CSR correspondant à chaque arc réel
+} NetworkSimplex;
+
+// Recherche par blocs de l'arc entrant : on examine block_size arcs à partir de *next_arc et on
+// retient le plus violé ; on ne continue au bloc suivant que si aucun arc n'était candidat.
+static int ns_find_entering_arc(const NetworkSimplex *N, int block_size, int *next_arc) {
+    long long best = 0;
+    int in_arc = -1;
+    int cnt = 0;
+    int e = *next_arc;
+    int k;
+    for (k = 0; k < N->num_arcs; k++) {
+        long long c = N->state[e] * (N->cost[e] + N->pi[N->source[e]] - N->pi[N->target[e]]);
+        if (c < best) {
+            best = c;
+            in_arc = e;
+        }
+        if (++e == N->num_arcs) e = 0;
+        if (++cnt == block_size) {
+            if (in_arc >= 0) break;
+            cnt = 0;
+        }
+    }
+    STAT_ADD(FLOW_STAT_ARCS_SCANNED, k < N->num_arcs ? k + 1 : k);
+    *next_arc = e;
+    return in_arc;
+}
+
+// Change la base : l'arc d'arbre pred[u_out] sort, in_arc entre et relie u_in (dans le
+// sous-arbre de u_out) à v_in. Le sous-arbre détaché est réenraciné en u_in puis raccroché
+// sous v_in ; seul ce segment de thread[] est recalculé.
+static void ns_update_tree(NetworkSimplex *N, int in_arc, int u_in, int v_in, int u_out, int join) {
+    int size = N->succ_num[u_out];
+
+    // Énumère le sous-arbre détaché : c'est le segment de thread[] qui commence en u_out
+    int last = u_out;
+    N->seg[0] = u_out;
+    for (int k = 1; k < size; k++) {
+        last = N->thread[last];
+        N->seg[k] = last;
+    }
+    int prev = N->rev_thread[u_out], next = N->thread[last]; // Retire le segment du thread
+    N->thread[prev] = next;
+    N->rev_thread[next] = prev;
+
+    for (int w = N->parent[u_out]; w != join; w = N->parent[w]) N->succ_num[w] -= size;
+    for (int w = v_in; w != join; w = N->parent[w]) N->succ_num[w] += size;
+
+    // Inverse le chemin u_in -> u_out : chaque sommet devient le parent de son ancien parent
+    long long sigma = (N->source[in_arc] == u_in)
+        ? N->pi[v_in] - N->cost[in_arc] - N->pi[u_in]
+        : N->cost[in_arc] + N->pi[v_in] - N->pi[u_in];
+    int u = u_in, new_parent = v_in, new_pred = in_arc;
+    while (1) {
+        int old_parent = N->parent[u], old_pred = N->pred[u];
+        N->parent[u] = new_parent;
+        N->pred[u] = new_pred;
+        N->up[u] = (N->source[new_pred] == u);
+        if (u == u_out) break;
+        new_parent = u;
+        new_pred = old_pred;
+        u = old_parent;
+    }
+
+    // Nouvel ordre préfixe du sous-arbre, à partir de listes de fils temporaires
+    for (int k = 0; k < size; k++) N->child_head[N->seg[k]] = -1;
+    for (int k = 0; k < size; k++) {
+        int x = N->seg[k];
+        if (x == u_in) continue;
+        N->child_next[x] = N->child_head[N->parent[x]];
+        N->child_head[N->parent[x]] = x;
+    }
+    int count = 0, top = 0;
+    int *stack = N->seg;                       // seg n'est plus utile : il sert de pile
+    stack[top++] = u_in;
+    while (top > 0) {
+        int x = stack[--top];
+        N->order[count++] = x;
+        N->depth[x] = N->depth[N->parent[x]] + 1;
+        N->pi[x] += sigma;                     // Tout le sous-arbre est décalé du même potentiel
+        N->succ_num[x] = 1;
+        for (int c = N->child_head[x]; c >= 0; c = N->child_next[c]) stack[top++] = c;
+    }
+    for (int k = count - 1; k > 0; k--) N->succ_num[N->parent[N->order[k]]] += N->succ_num[N->order[k]];
+
+    // Insère le segment juste après v_in dans le thread
+    next = N->thread[v_in];
+    N->thread[v_in] = N->order[0];
+    N->rev_thread[N->order[0]] = v_in;
+    for (int k = 1; k < count; k++) {
+        N->thread[N->order[k - 1]] = N->order[k];
+        N->rev_thread[N->order[k]] = N->order[k - 1];
+    }
+    N->thread[N->order[count - 1]] = next;
+    N->rev_thread[next] = N->order[count - 1];
+}
+
+// Simplexe des réseaux primal pour envoyer desired_flow unités de s à t à coût minimal.
+// La base initiale relie chaque sommet à une racine artificielle par un arc de coût prohibitif ;
+// si le flot désiré est impossible, le flot restant passe par ces arcs et seul le flot réel
+// atteignant t est compté. Retourne le flot atteint et place le coût total dans *cost_total.
+flow_sum_t network_simplex(FlowSolver *S, flow_sum_t desired_flow, flow_sum_t *cost_total) {
+    FlowNetwork *G = S->G;
+    int n = G->n;
+    solver_begin(S);
+    int root = n;
+    int num_real = 0;
+    long long max_cost = 0;
+    for (int a = 0; a < G->m; a++) {
+        if (G->capacity[a] > 0) {
+            num_real++;
+            long long c = G->cost[a] < 0 ? -(long long)G->cost[a] : G->cost[a];
+            if (c > max_cost) max_cost = c;
+        }
+    }
+
+    NetworkSimplex N;
+    N.num_nodes = n + 1;
+    N.num_arcs = num_real + n;
+    int A = N.num_arcs, V = N.num_nodes;
+    N.source = (int *)solver_alloc(S, A * sizeof(int));
+    N.target = (int *)solver_alloc(S, A * sizeof(int));
+    N.cap = (flow_sum_t *)solver_alloc(S, A * sizeof(flow_sum_t));
+    N.flow = (flow_sum_t *)solver_alloc(S, A * sizeof(flow_sum_t));
+    N.cost = (long long *)solver_alloc(S, A * sizeof(long long));
+    N.state = (signed char *)solver_alloc(S, A);
+    N.parent = (int *)solver_alloc(S, V * sizeof(int));
+    N.pred = (int *)solver_alloc(S, V * sizeof(int));
+    N.up = (signed char *)solver_alloc(S, V);
+    N.thread = (int *)solver_alloc(S, V * sizeof(int));
+    N.rev_thread = (int *)solver_alloc(S, V * sizeof(int));
+    N.succ_num = (int *)solver_alloc(S, V * sizeof(int));
+    N.depth = (int *)solver_alloc(S, V * sizeof(int));
+    N.pi = (long long *)solver_alloc(S, V * sizeof(long long));
+    N.seg = (int *)solver_alloc(S, V * sizeof(int));
+    N.order = (int *)solver_alloc(S, V * sizeof(int));
+    N.child_head = (int *)solver_alloc(S, V * sizeof(int));
+    N.child_next = (int *)solver_alloc(S, V * sizeof(int));
+    N.csr_arc = (int *)solver_alloc(S, (num_real > 0 ? num_real : 1) * sizeof(int));
+
+    int e = 0;
+    for (int u = 0; u < n; u++) {              // Arcs réels, hors base et à flot nul
+        for (int a = G->first[u]; a < G->first[u + 1]; a++) {
+            if (G->capacity[a] <= 0) continue;
+            N.source[e] = u;
+            N.target[e] = G->head[a];
+            N.cap[e] = G->capacity[a];
+            N.cost[e] = G->cost[a];
+            N.flow[e] = 0;
+            N.state[e] = NS_STATE_LOWER;
+            N.csr_arc[e] = a;
+            e++;
+        }
+    }
+
+    // Base initiale : s -> racine porte l'offre, racine -> t la demande, les autres sommets
+    // sont reliés à la racine par des arcs de flot nul. Ces derniers coûtent 2 * art_cost : un flot
+    // qui quitterait le réseau par l'un d'eux coûterait plus que l'arc s -> racine, si bien qu'à
+    // l'optimum le flot non acheminé (flot désiré inatteignable) reste sur s -> racine -> t.
+    long long art_cost = (max_cost + 1) * (long long)(n + 1);
+    N.parent[root] = -1;
+    N.pred[root] = -1;
+    N.depth[root] = 0;
+    N.pi[root] = 0;
+    N.succ_num[root] = V;
+    N.thread[root] = 0;
+    N.rev_thread[0] = root;
+    for (int u = 0; u < n; u++) {
+        e = num_real + u;
+        if (u == G->t && u != G->s) {
+            N.source[e] = root; N.target[e] = u;
+            N.flow[e] = desired_flow;
+            N.pi[u] = art_cost;
+            N.up[u] = 0;
+            N.cost[e] = art_cost;
+        } else {
+            N.source[e] = u; N.target[e] = root;
+            N.flow[e] = (u == G->s && u != G->t) ? desired_flow : 0;
+            N.cost[e] = (u == G->s) ? art_cost : 2 * art_cost;
+            N.pi[u] = -N.cost[e];
+            N.up[u] = 1;
+        }
+        N.cap[e] = LLONG_MAX;
+        N.state[e] = NS_STATE_TREE;
+        N.parent[u] = root;
+        N.pred[u] = e;
+        N.depth[u] = 1;
+        N.succ_num[u] = 1;
+        N.thread[u] = (u + 1 < n) ? u + 1 : root;
+        N.rev_thread[(u + 1 < n) ? u + 1 : root] = u;
+    }
+
+    int block_size = (int)sqrt((double)A);
+    if (block_size < 10) block_size = 10;
+    int next_arc = 0;
+    long pivots = 0;
+    int in_arc;
+    while ((in_arc = ns_find_entering_arc(&N, block_size, &next_arc)) >= 0) {
+        int first, second;                     // Le cycle parcourt first -> second par l'arc entrant
+        if (N.state[in_arc] == NS_STATE_LOWER) {
+            first = N.source[in_arc];
+            second = N.target[in_arc];
+        } else {
+            first = N.target[in_arc];
+            second = N.source[in_arc];
+        }
+
+        int u = N.source[in_arc], v = N.target[in_arc]; // Sommet de jonction des deux chemins
+        while (u != v) {
+            if (N.depth[u] > N.depth[v]) u = N.parent[u];
+            else if (N.depth[v] > N.depth[u]) v = N.parent[v];
+            else { u = N.parent[u]; v = N.parent[v]; }
+        }
+        int join = u;
+
+        // Arc sortant : le dernier arc bloquant dans le sens du cycle (arbre fortement réalisable)
+        flow_sum_t delta = N.cap[in_arc];
+        int u_out = -1, side = 0;
+        for (int w = first; w != join; w = N.parent[w]) {
+            flow_sum_t f = N.flow[N.pred[w]];
+            flow_sum_t d = N.up[w] ? f : N.cap[N.pred[w]] - f;  // Le flot descend de parent[w] vers w
+            if (d < delta) { delta = d; u_out = w; side = 1; }
+        }
+        for (int w = second; w != join; w = N.parent[w]) {
+            flow_sum_t f = N.flow[N.pred[w]];
+            flow_sum_t d = N.up[w] ? N.cap[N.pred[w]] - f : f;  // Le flot monte de w vers parent[w]
+            if (d <= delta) { delta = d; u_out = w; side = 2; }
+        }
+
+        if (delta > 0) {                       // Pousse delta le long du cycle
+            N.flow[in_arc] += N.state[in_arc] * delta;
+            for (int w = first; w != join; w = N.parent[w])
+                N.flow[N.pred[w]] += N.up[w] ? -delta : delta;
+            for (int w = second; w != join; w = N.parent[w])
+                N.flow[N.pred[w]] += N.up[w] ? delta : -delta;
+        }
+
+        if (side == 0) {                       // L'arc entrant passe d'une borne à l'autre
+            N.state[in_arc] = -N.state[in_arc];
+        } else {
+            int out_arc = N.pred[u_out];
+            N.state[out_arc] = (N.flow[out_arc] == 0) ? NS_STATE_LOWER : NS_STATE_UPPER;
+            N.state[in_arc] = NS_STATE_TREE;
+            int u_in = (side == 1) ? first : second;
+            int v_in = (side == 1) ? second : first;
+            ns_update_tree(&N, in_arc, u_in, v_in, u_out, join);
+        }
+        pivots++;
+        STAT_ADD(FLOW_STAT_PIVOTS, 1);
+    }
+
+    int cost_ok = 1;
+    *cost_total = 0;
+    for (e = 0; e < num_real; e++)
+        cost_ok &= cost_accumulate(cost_total, N.flow[e], N.cost[e]);
+    int art_t = num_real + G->t;               // Le flot arrivant à t par la racine n'est pas réel
+    flow_sum_t flow = (G->s == G->t) ? 0 : desired_flow - N.flow[art_t];
+    if (G->arc_flow) {                         // Les arcs sans capacité (inverses) gardent un flot nul
+        memset(G->arc_flow, 0, G->m * sizeof(flow_cap_t));
+        for (e = 0; e < num_real; e++)
+            G->arc_flow[N.csr_arc[e]] = (flow_cap_t)N.flow[e];
+    }
+
+    if (TRACE_ENABLED(TRACE_RESULT)) {
+        printf("Simplexe des réseaux : %ld pivots\n", pivots);
+        if (flow < desired_flow) {
+            printf("Impossible d'atteindre le flot désiré.\n");
+        } else {
+            printf("Flot atteint = %lld, Coût total = %lld\n", flow, *cost_total);
+        }
+    }
+    if (!cost_ok) cost_overflow_warning();
+
+    solver_end(S);
+    return flow;
+}
+
+
+// Réseaux en grille implicites (segmentation d'images, routage spatial). Les voisins d'une cellule se
+// déduisent de ses coordonnées : seuls les tableaux de capacités par direction sont stockés, sans CSR ni
+// matrice. Fichier texte : une ligne "grid nx ny" (ou "grid nx ny nz" en 3D), puis une ligne par cellule,
+// x variant le plus vite : capacité depuis la source, capacité vers le puits, puis capacités vers les voisins
+// +x, -x, +y, -y (et +z, -z). Une capacité vers l'extérieur de la grille est ignorée.
+// Le flot d'une paire source -> i -> puits est acquis dès le chargement (terminal_flow) : il reste à
+// chaque cellule une seule capacité terminale, positive (depuis la source) ou négative (vers le puits).
+
+// Reconnaît un fichier grille à son premier mot
+int is_grid_file(const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) return 0;
+    char word[5] = "";
+    int ok = fscanf(f, " %4s", word) == 1 && strcmp(word, "grid") == 0;
+    fclose(f);
+    return ok;
+}
+
+// Voisins de la cellule i dans chaque direction (-1 hors de la grille)
+static void grid_neighbors(const GridNetwork *G, int i, int *nb) {
+    int x = i % G->nx, y = (i / G->nx) % G->ny, z = i / (G->nx * G->ny);
+    int plane = G->nx * G->ny;
+    nb[0] = x < G->nx - 1 ? i + 1 : -1;
+    nb[1] = x > 0 ? i - 1 : -1;
+    nb[2] = y < G->ny - 1 ? i + G->nx : -1;
+    nb[3] = y > 0 ? i - G->nx : -1;
+    if (G->dims == 3) {
+        nb[4] = z < G->nz - 1 ? i + plane : -1;
+        nb[5] = z > 0 ? i - plane : -1;
+    }
+}
+
+// Lit un entier positif ou nul ; retourne 0 s'il n'y en a pas, -1 s'il dépasse limit
+static int grid_parse_value(const char **pp, const char *end, long long limit, long long *value) {
+    const char *p = *pp;
+    while (p < end && IS_BLANK(*p)) p++;
+    if (p == end || *p < '0' || *p > '9') return 0;
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (v > (limit - (*p - '0')) / 10) return -1;
+        v = v * 10 + (*p++ - '0');
+    }
+    if (p < end && !IS_BLANK(*p)) return 0;
+    *pp = p;
+    *value = v;
+    return 1;
+}
+
+// Charge un fichier grille dans G. Retourne 1 en cas de succès, 0 sinon (message sur stderr).
+int read_grid_file(const char *filename, GridNetwork *G) {
+    memset(G, 0, sizeof(GridNetwork));
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Impossible d'ouvrir le fichier %s. Vérifiez le nom et réessayez.\n", filename);
+        return 0;
+    }
+    struct stat st;
+    size_t size = (fstat(fd, &st) == 0) ? (size_t)st.st_size : 0;
+    const char *text = (size > 0) ? (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (text == MAP_FAILED) {
+        fprintf(stderr, "Fichier grille %s invalide : en-tête 'grid nx ny [nz]' attendu.\n", filename);
+        return 0;
+    }
+    const char *p = text, *end = text + size;
+    const char *error = NULL;
+
+    // En-tête : grid nx ny [nz]
+    long long dim[3] = { 1, 1, 1 };
+    int dims = 0;
+    while (p < end && IS_BLANK(*p)) p++;
+    if (end - p < 4 || memcmp(p, "grid", 4) != 0) error = "en-tête 'grid nx ny [nz]' attendu";
+    else p += 4;
+    while (!error && dims < 3) {
+        const char *q = p;
+        while (q < end && IS_BLANK(*q) && *q != '\n') q++;
+        if (q == end || *q == '\n') break;  // Fin de l'en-tête
+        p = q;
+        if (grid_parse_value(&p, end, INT_MAX / 2, &dim[dims]) != 1 || dim[dims] < 1) error = "dimensions invalides";
+        dims++;
+    }
+    if (!error && dims < 2) error = "en-tête 'grid nx ny [nz]' attendu";
+    if (!error && (dim[0] * dim[1] > INT_MAX / 2 || dim[0] * dim[1] * dim[2] > INT_MAX / 2)) error = "grille trop grande";
+
+    if (!error) {
+        G->nx = (int)dim[0];
+        G->ny = (int)dim[1];
+        G->nz = (int)dim[2];
+        G->dims = dims;
+        G->cells = G->nx * G->ny * G->nz;
+        G->terminal = (flow_cap_t *)malloc(G->cells * sizeof(flow_cap_t));
+        int ok = G->terminal != NULL;
+        for (int d = 0; d < 2 * dims; d++) {
+            G->cap[d] = (flow_cap_t *)malloc(G->cells * sizeof(flow_cap_t));
+            ok = ok && G->cap[d];
+        }
+        if (!ok) error = "mémoire insuffisante";
+    }
+
+    // Une ligne par cellule : source, puits, puis une capacité par direction
+    int nb[GRID_MAX_DIRS];
+    for (int i = 0; !error && i < G->cells; i++) {
+        long long v[2 + GRID_MAX_DIRS];
+        for (int k = 0; k < 2 + 2 * dims; k++) {
+            int r = grid_parse_value(&p, end, FLOW_CAP_MAX, &v[k]);
+            if (r <= 0) {
+                error = r < 0 ? "valeur trop grande pour FLOW_CAP_BITS" : "valeur manquante ou invalide";
+                break;
+            }
+        }
+        if (error) break;
+        flow_cap_t source = (flow_cap_t)v[0], sink = (flow_cap_t)v[1];
+        G->terminal_flow += source < sink ? source : sink;
+        G->terminal[i] = source - sink;
+        grid_neighbors(G, i, nb);
+        for (int d = 0; d < 2 * dims; d++)
+            G->cap[d][i] = nb[d] >= 0 ? (flow_cap_t)v[2 + d] : 0;
+    }
+    while (!error && p < end && IS_BLANK(*p)) p++;
+    if (!error && p < end) error = "valeurs en trop après la dernière cellule";
+
+    // Un arc et son opposé se partagent leurs deux capacités pendant la résolution
+    for (int i = 0; !error && i < G->cells; i++) {
+        grid_neighbors(G, i, nb);
+        for (int d = 0; d < 2 * dims; d += 2)
+            if (nb[d] >= 0 && G->cap[d][i] > FLOW_CAP_MAX - G->cap[d + 1][nb[d]])
+                error = "capacités opposées trop grandes pour FLOW_CAP_BITS";
+    }
+    munmap((void *)text, size);
+
+    if (error) {
+        fprintf(stderr, "Fichier grille %s invalide : %s.\n", filename, error);
+        free_grid_network(G);
+        return 0;
+    }
+    return 1;
+}
+
+void free_grid_network(GridNetwork *G) {
+    free(G->terminal);
+    for (int d = 0; d < GRID_MAX_DIRS; d++) free(G->cap[d]);
+    memset(G, 0, sizeof(GridNetwork));
+}
+
+// Flot maximal sur une grille par l'algorithme de Boykov-Kolmogorov. Deux arbres de recherche, enracinés
+// l'un à la source, l'autre au puits, grandissent par leurs sommets actifs jusqu'à se toucher ; le chemin
+// trouvé est augmenté, ce qui rend orphelins les sommets dont l'arc vers leur parent est saturé. Ceux-ci
+// cherchent un nouveau parent dans leur arbre (dont l'origine est encore un terminal, vérifiée avec des
+// marques de passage et des distances) ou redeviennent libres. Les arbres sont conservés d'un chemin à
+// l'autre au lieu d'être reconstruits, ce qui convient aux grilles où les chemins sont courts et nombreux.
+// parent[i] est la direction de i vers son parent, GRID_TERMINAL pour une racine.
+#define GRID_TERMINAL GRID_MAX_DIRS     // Racine : reliée directement à la source ou au puits
+#define GRID_ORPHAN (GRID_MAX_DIRS + 1) // Arc vers le parent saturé, en attente d'adoption
+enum { GRID_FREE, GRID_SOURCE, GRID_SINK };
+
+typedef struct {
+    GridNetwork *G;
+    int offset[GRID_MAX_DIRS];  // Décalage d'indice vers le voisin de chaque direction
+    unsigned char *tree;        // GRID_FREE, GRID_SOURCE ou GRID_SINK
+    unsigned char *parent;      // Direction vers le parent, GRID_TERMINAL ou GRID_ORPHAN
+    unsigned char *active;      // 1 : dans la file des actifs
+    int *stamp, *dist;          // Marque du dernier passage qui a vérifié l'origine, distance à la racine
+    int *queue, queue_head, queue_size; // File circulaire des sommets actifs (au plus une fois chacun)
+    int *orphans, orphan_head, orphan_size; // File circulaire des orphelins
+    int time;                   // Numéro de la phase d'adoption courante
+} GridBK;
+
+static void grid_activate(GridBK *B, int i) {
+    if (B->active[i]) return;
+    B->active[i] = 1;
+    B->queue[(B->queue_head + B->queue_size++) % B->G->cells] = i;
+}
+
+static void grid_make_orphan(GridBK *B, int i) {
+    B->parent[i] = GRID_ORPHAN;
+    B->orphans[(B->orphan_head + B->orphan_size++) % B->G->cells] = i;
+}
+
+// Capacité résiduelle de l'arc qui relie i à son voisin q (direction d) dans le sens de l'arbre tree :
+// du parent vers l'enfant dans l'arbre de la source, de l'enfant vers le parent dans celui du puits
+static inline flow_cap_t grid_tree_cap(const GridNetwork *G, int tree, int i, int d, int q) {
+    return tree == GRID_SOURCE ? G->cap[d][i] : G->cap[d ^ 1][q];
+}
+
+// Fait grandir les arbres depuis les sommets actifs. Retourne 1 et l'arc (*u, *dir), de l'arbre de la
+// source vers celui du puits, dès que les arbres se touchent ; 0 s'il n'y a plus de sommet actif.
+static int grid_grow(GridBK *B, int *u, int *dir) {
+    GridNetwork *G = B->G;
+    int nb[GRID_MAX_DIRS];
+    while (B->queue_size > 0) {
+        int p = B->queue[B->queue_head];
+        if (B->tree[p] == GRID_FREE) {      // Libéré depuis son activation
+            B->active[p] = 0;
+            B->queue_head = (B->queue_head + 1) % G->cells;
+            B->queue_size--;
+            continue;
+        }
+        int tp = B->tree[p];
+        grid_neighbors(G, p, nb);
+        for (int d = 0; d < 2 * G->dims; d++) {
+            int q = nb[d];
+            if (q < 0 || grid_tree_cap(G, tp, p, d, q) <= 0) continue;
+            if (B->tree[q] == GRID_FREE) {  // q rejoint l'arbre de p
+                B->tree[q] = (unsigned char)tp;
+                B->parent[q] = (unsigned char)(d ^ 1);
+                B->stamp[q] = B->stamp[p];
+                B->dist[q] = B->dist[p] + 1;
+                grid_activate(B, q);
+            } else if (B->tree[q] != tp) {  // Les arbres se touchent : p reste actif pour la suite
+                *u = tp == GRID_SOURCE ? p : q;
+                *dir = tp == GRID_SOURCE ? d : d ^ 1;
+                return 1;
+            } else if (B->stamp[q] <= B->stamp[p] && B->dist[q] > B->dist[p]) { // Raccourcit la branche de q
+                B->parent[q] = (unsigned char)(d ^ 1);
+                B->stamp[q] = B->stamp[p];
+                B->dist[q] = B->dist[p] + 1;
+            }
+        }
+        B->active[p] = 0;                   // Plus rien à explorer depuis p
+        B->queue_head = (B->queue_head + 1) % G->cells;
+        B->queue_size--;
+    }
+    return 0;
+}
+
+// Augmente le chemin racine de la source -> u -> (direction dir) -> racine du puits ; retourne son flot
+static flow_cap_t grid_augment(GridBK *B, int u, int dir) {
+    GridNetwork *G = B->G;
+    int v = u + B->offset[dir];
+    flow_cap_t path_flow = G->cap[dir][u];
+    int x, d;
+    for (x = u; (d = B->parent[x]) != GRID_TERMINAL; x += B->offset[d])  // Côté source : arcs parent -> x
+        if (G->cap[d ^ 1][x + B->offset[d]] < path_flow) path_flow = G->cap[d ^ 1][x + B->offset[d]];
+    if (G->terminal[x] < path_flow) path_flow = G->terminal[x];
+    for (x = v; (d = B->parent[x]) != GRID_TERMINAL; x += B->offset[d])  // Côté puits : arcs x -> parent
+        if (G->cap[d][x] < path_flow) path_flow = G->cap[d][x];
+    if (-G->terminal[x] < path_flow) path_flow = -G->terminal[x];
+
+    G->cap[dir][u] -= path_flow;
+    G->cap[dir ^ 1][v] += path_flow;
+    for (x = u; ; ) {
+        d = B->parent[x];
+        if (d == GRID_TERMINAL) {
+            G->terminal[x] -= path_flow;
+            if (G->terminal[x] == 0) grid_make_orphan(B, x);
+            break;
+        }
+        int y = x + B->offset[d];
+        G->cap[d ^ 1][y] -= path_flow;
+        G->cap[d][x] += path_flow;
+        if (G->cap[d ^ 1][y] == 0) grid_make_orphan(B, x);
+        x = y;
+    }
+    for (x = v; ; ) {
+        d = B->parent[x];
+        if (d == GRID_TERMINAL) {
+            G->terminal[x] += path_flow;
+            if (G->terminal[x] == 0) grid_make_orphan(B, x);
+            break;
+        }
+        int y = x + B->offset[d];
+        G->cap[d][x] -= path_flow;
+        G->cap[d ^ 1][y] += path_flow;
+        if (G->cap[d][x] == 0) grid_make_orphan(B, x);
+        x = y;
+    }
+    return path_flow;
+}
+
+// Cherche un nouveau parent pour chaque orphelin ; un orphelin sans parent possible redevient libre et
+// ses enfants deviennent orphelins à leur tour
+static void grid_adopt(GridBK *B) {
+    GridNetwork *G = B->G;
+    int nb[GRID_MAX_DIRS];
+    B->time++;
+    while (B->orphan_size > 0) {
+        int o = B->orphans[B->orphan_head];
+        B->orphan_head = (B->orphan_head + 1) % G->cells;
+        B->orphan_size--;
+        int to = B->tree[o];
+        grid_neighbors(G, o, nb);
+
+        int best = -1, best_dist = INT_MAX;
+        for (int d = 0; d < 2 * G->dims; d++) {
+            int q = nb[d];
+            if (q < 0 || B->tree[q] != to || grid_tree_cap(G, to, q, d ^ 1, o) <= 0) continue;
+            int length = 0, k = q;          // Remonte jusqu'à une racine ou un sommet déjà vérifié
+            while (1) {
+                if (B->stamp[k] == B->time) { length += B->dist[k]; break; }
+                int pd = B->parent[k];
+                length++;
+                if (pd == GRID_TERMINAL) { B->stamp[k] = B->time; B->dist[k] = 1; break; }
+                if (pd == GRID_ORPHAN) { length = INT_MAX; break; }
+                k += B->offset[pd];
+            }
+            if (length == INT_MAX) continue;
+            if (length < best_dist) {
+                best = d;
+                best_dist = length;
+            }
+            for (k = q; B->stamp[k] != B->time; k += B->offset[B->parent[k]]) { // Marque la branche vérifiée
+                B->stamp[k] = B->time;
+                B->dist[k] = length--;
+            }
+        }
+
+        if (best >= 0) {                    // Adopté par le voisin le plus proche de sa racine
+            B->parent[o] = (unsigned char)best;
+            B->stamp[o] = B->time;
+            B->dist[o] = best_dist + 1;
+            continue;
+        }
+        for (int d = 0; d < 2 * G->dims; d++) {
+            int q = nb[d];
+            if (q < 0 || B->tree[q] != to) continue;
+            if (grid_tree_cap(G, to, q, d ^ 1, o) > 0) grid_activate(B, q); // q pourra réatteindre o
+            if (B->parent[q] == (d ^ 1)) grid_make_orphan(B, q);            // Le parent de q était o
+        }
+        B->tree[o] = GRID_FREE;
+    }
+}
+
+// Flot maximal de la grille G (terminal_flow compris). Les capacités de G deviennent les capacités
+// résiduelles : la grille n'est pas recopiée. G->source_side reçoit la coupe minimale s'il est fourni.
+// Retourne -1 si la mémoire manque.
+flow_sum_t grid_max_flow(GridNetwork *G) {
+    GridBK B;
+    memset(&B, 0, sizeof(B));
+    B.G = G;
+    int n = G->cells;
+    B.offset[0] = 1;
+    B.offset[1] = -1;
+    B.offset[2] = G->nx;
+    B.offset[3] = -G->nx;
+    B.offset[4] = G->nx * G->ny;
+    B.offset[5] = -G->nx * G->ny;
+    B.tree = (unsigned char *)malloc(n);
+    B.parent = (unsigned char *)malloc(n);
+    B.active = (unsigned char *)calloc(n, 1);
+    B.stamp = (int *)malloc(n * sizeof(int));
+    B.dist = (int *)malloc(n * sizeof(int));
+    B.queue = (int *)malloc(n * sizeof(int));
+    B.orphans = (int *)malloc(n * sizeof(int));
+    flow_sum_t flow = -1;
+    if (B.tree && B.parent && B.active && B.stamp && B.dist && B.queue && B.orphans) {
+        trace_begin();
+        for (int i = 0; i < n; i++) {       // Racines : cellules encore reliées à un terminal
+            B.tree[i] = G->terminal[i] > 0 ? GRID_SOURCE : G->terminal[i] < 0 ? GRID_SINK : GRID_FREE;
+            B.parent[i] = GRID_TERMINAL;
+            B.stamp[i] = 0;
+            B.dist[i] = 1;
+            if (B.tree[i] != GRID_FREE) grid_activate(&B, i);
+        }
+        flow = G->terminal_flow;
+        int u, dir;
+        while (grid_grow(&B, &u, &dir)) {
+            flow_cap_t path_flow = grid_augment(&B, u, dir);
+            TRACE_EVENT(TRACE_PATHS, TRACE_EV_PATH, path_flow, 0, 0);
+            flow += path_flow;
+            grid_adopt(&B);
+        }
+        if (G->source_side)
+            for (int i = 0; i < n; i++) G->source_side[i] = B.tree[i] == GRID_SOURCE;
+        trace_end();
+    }
+    free(B.tree);
+    free(B.parent);
+    free(B.active);
+    free(B.stamp);
+    free(B.dist);
+    free(B.queue);
+    free(B.orphans);
+    return flow;
+}
@@ -0,0 +1,190 @@
+// Bibliothèque de flot commune aux programmes du projet (test_unitaire, benchmark, générateur,
+// convertisseur) : représentation CSR des réseaux, lecture et écriture des fichiers (texte, DIMACS,
+// binaire), traces et solveurs de flot maximal et de flot à coût minimal. Les solveurs travaillent
+// dans un contexte FlowSolver qui garde leurs tableaux d'une résolution à l'autre.
+#ifndef FLOW_H
+#define FLOW_H
+
+#include <stddef.h>     // size_t
+#include <stdint.h>     // int16_t, int32_t
+#include <limits.h>     // LLONG_MAX
+
+// Largeur des capacités et des coûts stockés dans le graphe et les graphes résiduels, choisie à la
+// compilation : -DFLOW_CAP_BITS=16|32|64 et -DFLOW_COST_BITS=16|32|64 (32 par défaut). Des cases de
+// 16 bits divisent par deux le volume parcouru par les solveurs ; une valeur de fichier qui dépasse la
+// largeur choisie est refusée au chargement. Les valeurs de flot, les excès et les coûts totaux sont
+// toujours cumulés sur 64 bits (flow_sum_t), et le cumul des coûts est contrôlé contre le dépassement.
+#ifndef FLOW_CAP_BITS
+#define FLOW_CAP_BITS 32
+#endif
+#ifndef FLOW_COST_BITS
+#define FLOW_COST_BITS 32
+#endif
+
+#if FLOW_CAP_BITS == 16
+typedef int16_t flow_cap_t;
+#define FLOW_CAP_MAX INT16_MAX
+#elif FLOW_CAP_BITS == 32
+typedef int32_t flow_cap_t;
+#define FLOW_CAP_MAX INT32_MAX
+#elif FLOW_CAP_BITS == 64
+typedef long long flow_cap_t;
+#define FLOW_CAP_MAX LLONG_MAX
+#else
+#error "FLOW_CAP_BITS doit valoir 16, 32 ou 64"
+#endif
+
+#if FLOW_COST_BITS == 16
+typedef int16_t flow_cost_t;
+#define FLOW_COST_MAX INT16_MAX
+#elif FLOW_COST_BITS == 32
+typedef int32_t flow_cost_t;
+#define FLOW_COST_MAX INT32_MAX
+#elif FLOW_COST_BITS == 64
+typedef long long flow_cost_t;
+#define FLOW_COST_MAX LLONG_MAX
+#else
+#error "FLOW_COST_BITS doit valoir 16, 32 ou 64"
+#endif
+
+typedef long long flow_sum_t;   // Valeur d'un flot, excès d'un sommet, coût total
+
+// Définition d'une structure FlowNetwork pour représenter un réseau de flot.
+// Le graphe est stocké au format CSR (compressed sparse row) : chaque arc du fichier
+// est accompagné de son arc inverse, et les deux sont reliés par le tableau rev[].
+// La mémoire est en O(n + m) et le parcours des voisins de u coûte son degré, pas n.
+typedef struct {
+    int n;              // Nombre de sommets dans le réseau
+    int m;              // Nombre d'arcs du graphe résiduel (arcs directs + arcs inverses)
+    int *first;         // Tableau de n+1 indices : les arcs sortants de u sont first[u] .. first[u+1]-1
+    int *head;          // head[a] : sommet d'arrivée de l'arc a
+    int *rev;           // rev[a] : indice de l'arc inverse apparié à l'arc a
+    flow_cap_t *capacity; // capacity[a] : capacité de l'arc a (0 pour un arc inverse)
+    flow_cost_t *cost;  // cost[a] : coût de l'arc a (opposé du coût direct pour un arc inverse), NULL si pas de coûts
+    int s, t;           // Indices de la source (s) et du puits (t)
+    int isMinCost;      // Indicateur (0 ou 1) pour savoir si c'est un problème de flot max (0) ou min (1)
+    void *mapping;      // Projection mémoire du fichier binaire (les tableaux pointent dedans), NULL sinon
+    size_t mapping_size; // Taille de la projection
+    int demand;         // Flot imposé par le fichier (offres d'un fichier DIMACS min), 0 sinon
+    int input_nodes;    // Sommets décrits par le fichier ; les suivants (super-source, super-puits) sont ajoutés
+    flow_cap_t *arc_flow; // Si non NULL, les solveurs y écrivent le flot final de chaque arc direct (taille m)
+} FlowNetwork;
+
+// Graphes : construction, fichiers et affichage
+int build_csr(FlowNetwork *G, int num_edges, const int *tail, const int *head, const flow_cap_t *cap, const flow_cost_t *cost);
+void free_flow_network(FlowNetwork *G);
+void print_matrix(const FlowNetwork *G, const flow_cap_t *values, const char *title);
+void print_cost_matrix(const FlowNetwork *G, const char *title);
+int write_binary_file(const char *filename, const FlowNetwork *G);
+int is_binary_file(const char *filename);
+int read_binary_file(const char *filename, FlowNetwork *G);
+int is_dimacs_file(const char *filename);
+int write_dimacs_solution(const char *filename, const FlowNetwork *G, const flow_cap_t *arc_flow, flow_sum_t value);
+int read_input_file(const char *filename, FlowNetwork *G);
+
+// Niveaux de trace (trace_set_level, propre à chaque thread)
+#define TRACE_NONE   0  // Aucune sortie (benchmark)
+#define TRACE_RESULT 1  // Une ligne de résultat par résolution
+#define TRACE_PATHS  2  // + une ligne par chemin augmentant ou par phase
+#define TRACE_STEPS  3  // + chaque envoi, réétiquetage et table de Bellman-Ford (format des fichiers Traces/)
+
+void trace_set_level(int level);
+int simd_set_level(int level);          // 0 scalaire, 1 AVX2, 2 AVX-512 ; retourne le niveau retenu
+void bfs_set_threads(int num_threads);  // Threads des parcours en largeur (0 = un par cœur)
+void reduction_set_enabled(int enabled); // Réduction des graphes par flow_solver_init (1 par défaut)
+
+// Compteurs d'une résolution, remis à zéro au début de chacune et rangés dans FlowSolver.stats à la fin.
+// Un solveur ne remplit que les compteurs de ses opérations ; -DFLOW_STATS=0 les retire des boucles.
+enum {
+    FLOW_STAT_AUGMENTATIONS,        // Chemins ou chaînes augmentants (Ford-Fulkerson, Dinic, coût minimal)
+    FLOW_STAT_BFS_RUNS,             // Parcours en largeur (chemins, niveaux de Dinic, réétiquetages globaux)
+    FLOW_STAT_ARCS_SCANNED,         // Arcs examinés par les parcours, recherches d'arcs admissibles et relaxations
+    FLOW_STAT_PUSHES_SATURATING,    // Envois qui saturent l'arc
+    FLOW_STAT_PUSHES_NONSATURATING, // Envois qui vident l'excès sans saturer l'arc
+    FLOW_STAT_RELABELS,
+    FLOW_STAT_GLOBAL_RELABELS,
+    FLOW_STAT_BELLMAN_FORD_PASSES,  // Passes de relaxation sur tous les sommets
+    FLOW_STAT_PIVOTS,               // Pivots du simplexe des réseaux
+    FLOW_STAT_COUNT
+};
+typedef struct {
+    long long count[FLOW_STAT_COUNT];
+} FlowStats;
+extern const char *const flow_stat_names[FLOW_STAT_COUNT]; // Noms des compteurs dans les sorties (bfs_runs...)
+
+// Contexte de résolution d'un graphe : les tableaux de travail des solveurs (graphe résiduel, hauteurs,
+// files, distances...) sont découpés dans une arène allouée une fois, dimensionnée pour le graphe, puis
+// réutilisée à chaque chemin augmentant et à chaque nouvelle résolution. Si un solveur demande plus que
+// l'arène, le complément est alloué à part et l'arène est agrandie au début de la résolution suivante.
+// Un contexte sert un seul thread à la fois ; plusieurs contextes peuvent partager le même graphe.
+// Avant tout calcul, le graphe est réduit (sommets et arcs qui ne portent aucun flot de s à t retirés,
+// chaînes de sommets de degré 2 contractées, arcs parallèles fusionnés) : les solveurs travaillent sur
+// le graphe réduit G et le flot de chaque arc est reporté sur network->arc_flow en fin de résolution.
+typedef struct FlowReduction FlowReduction;
+typedef struct {
+    FlowNetwork *G;             // Graphe résolu : network ou son graphe réduit
+    FlowNetwork *network;       // Graphe passé à flow_solver_init
+    FlowReduction *reduction;   // Graphe réduit et correspondance de ses arcs, NULL si network est résolu tel quel
+    unsigned char *arena;       // Bloc des tableaux de travail, aligné sur 64 octets
+    size_t arena_size;          // Taille du bloc
+    size_t arena_used;          // Octets distribués depuis le début de la résolution courante
+    size_t arena_peak;          // Plus grand besoin d'une résolution (taille du bloc à la suivante)
+    void *overflow;             // Blocs alloués hors de l'arène pendant la résolution courante
+    struct BFSWorkspace *bfs;   // Parcours en largeur et leurs threads, créés au premier usage
+    FlowStats stats;            // Compteurs de la dernière résolution
+} FlowSolver;
+
+int flow_solver_init(FlowSolver *S, FlowNetwork *G);  // Retourne 1 en cas de succès, 0 sinon
+void flow_solver_free(FlowSolver *S);
+
+// Flot maximal : retourne la valeur du flot (G->arc_flow reçoit le flot de chaque arc s'il est fourni)
+flow_sum_t ford_fulkerson(FlowSolver *S);
+flow_sum_t capacity_scaling(FlowSolver *S);               // Ford-Fulkerson par phases de seuil delta
+flow_sum_t push_relabel(FlowSolver *S);
+flow_sum_t push_relabel_highest_label(FlowSolver *S);
+flow_sum_t push_relabel_parallel(FlowSolver *S, int num_threads);   // 0 = un thread par cœur
+flow_sum_t dinic(FlowSolver *S);
+
+// Flot à coût minimal de valeur desired_flow (ou moins s'il n'est pas atteignable)
+flow_sum_t min_cost_flow(FlowSolver *S, flow_sum_t desired_flow);
+flow_sum_t min_cost_flow_dijkstra(FlowSolver *S, flow_sum_t desired_flow, flow_sum_t *cost_total);
+flow_sum_t network_simplex(FlowSolver *S, flow_sum_t desired_flow, flow_sum_t *cost_total);
+flow_sum_t flow_cost_of(const FlowNetwork *G, const flow_cap_t *arc_flow); // Coût d'un flot arc par arc
+
+// Re-résolution incrémentale du flot maximal après des modifications de capacités
+typedef struct {
+    const FlowNetwork *G;
+    flow_cap_t *capacity; // Capacités courantes (copie : G->capacity peut être projeté en lecture seule)
+    flow_cap_t *residual; // Graphe résiduel du dernier flot, conservé entre deux résolutions
+    int *parent_arc;    // Arc qui atteint chaque sommet dans le parcours courant
+    int *mark;          // mark[v] == stamp : v atteint par le parcours courant
+    int *queue;         // File du parcours en largeur
+    int stamp;          // Numéro du parcours courant
+    flow_sum_t flow;    // Valeur du flot courant
+} IncrementalFlow;
+
+int flow_find_arc(const FlowNetwork *G, int u, int v);
+flow_sum_t incremental_flow_init(IncrementalFlow *F, const FlowNetwork *G);
+flow_sum_t incremental_flow_update(IncrementalFlow *F, int count, const int *arcs, const flow_sum_t *deltas);
+void incremental_flow_free(IncrementalFlow *F);
+
+// Réseau en grille 2D ou 3D implicite : les voisins d'une cellule se déduisent de ses coordonnées et seules
+// les capacités par direction sont stockées (pas de CSR). Directions : 0 = +x, 1 = -x, 2 = +y, 3 = -y,
+// 4 = +z, 5 = -z ; la direction opposée à d est d ^ 1.
+#define GRID_MAX_DIRS 6
+typedef struct {
+    int nx, ny, nz;     // Dimensions (nz = 1 pour une grille 2D)
+    int dims;           // 2 ou 3 : nombre de directions utilisées = 2 * dims
+    int cells;          // nx * ny * nz ; la cellule (x, y, z) a l'indice x + nx * (y + ny * z)
+    flow_cap_t *terminal; // > 0 : capacité depuis la source ; < 0 : capacité vers le puits
+    flow_cap_t *cap[GRID_MAX_DIRS]; // cap[d][i] : capacité de l'arc de i vers son voisin de direction d (0 au bord)
+    flow_sum_t terminal_flow; // Flot des chemins source -> i -> puits, déjà retiré de terminal au chargement
+    unsigned char *source_side; // Si non NULL, grid_max_flow y écrit 1 pour les cellules du côté source de la coupe
+} GridNetwork;
+
+int is_grid_file(const char *filename);
+int read_grid_file(const char *filename, GridNetwork *G);
+void free_grid_network(GridNetwork *G);
+flow_sum_t grid_max_flow(GridNetwork *G);  // Boykov-Kolmogorov ; les capacités deviennent résiduelles
+
+#endif
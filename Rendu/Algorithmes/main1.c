@@ -1,321 +1,267 @@
 #include <stdio.h>      // Inclusion de la bibliothèque standard d'entrée/sortie
 #include <stdlib.h>     // Inclusion de la bibliothèque standard pour malloc, free, etc.
 #include <string.h>     // Inclusion de la bibliothèque pour strcmp, etc.
-#include <limits.h>     // Inclusion de la bibliothèque pour INT_MAX
-#include <time.h>
-#include <math.h>
+#include <time.h>       // clock_gettime (mode lot)
+#include <unistd.h>     // getopt
+#include "flow.h"       // Graphes, fichiers et solveurs (bibliothèque commune)
+
+// Mode lot : sans interaction ni affichage des matrices, chaque tâche (fichier, algorithme, flot désiré)
+// produit une ligne JSON sur la sortie standard, écrite dès la fin de la résolution. Les tâches viennent
+// de la ligne de commande ou d'une liste lue ligne par ligne (l'entrée standard avec -l -), ce qui permet
+// de piloter un seul processus depuis un script. Le dernier graphe chargé, avec son contexte de
+// résolution, est gardé tant que les tâches suivantes portent sur le même fichier. Un fichier grille est
+// rechargé à chaque tâche : grid_max_flow travaille directement sur ses capacités.
+static const char *batch_algorithms[] = { "ff", "pr", "dinic", "prhl", "ppr", "cs", "bk", "min", "dij", "ns" };
+#define BATCH_NUM_ALGORITHMS ((int)(sizeof(batch_algorithms) / sizeof(batch_algorithms[0])))
+#define BATCH_GRID 6                // bk : fichiers grille uniquement
+#define BATCH_FIRST_MIN_COST 7      // Les algorithmes suivants sont des flots à coût minimal
 
-// Définition d'une structure FlowNetwork pour représenter un réseau de flot
 typedef struct {
-    int n;              // Nombre de sommets dans le réseau
-    int **capacity;     // Pointeur sur une matrice des capacités (n x n)
-    int **cost;         // Pointeur sur une matrice des coûts (n x n), NULL si pas de coûts
-    int s, t;           // Indices de la source (s) et du puits (t)
-    int isMinCost;      // Indicateur (0 ou 1) pour savoir si c'est un problème de flot max (0) ou min (1)
-} FlowNetwork;
+    char filename[4096];            // Fichier du graphe chargé, "" si aucun
+    FlowNetwork G;
+    FlowSolver solver;              // Tableaux de travail du graphe, réutilisés d'une tâche à l'autre
+    double load_seconds;            // Temps de chargement du graphe (0 s'il était déjà chargé)
+} BatchState;
+
+static double batch_now(void) {     // Horloge monotone, en secondes
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
 
-// Fonction pour allouer une matrice n x n d'entiers et l'initialiser à 0
-int **allocate_matrix(int n) {
-    int **mat = (int **)malloc(n * sizeof(int *)); // Alloue un tableau de n pointeurs vers des int*
-    for (int i = 0; i < n; i++) {                   // Boucle sur chaque ligne
-        mat[i] = (int *)calloc(n, sizeof(int));     // Alloue et initialise à 0 une ligne de n int
-    }
-    return mat; // Retourne le pointeur vers la matrice allouée
+static int batch_find_algorithm(const char *name) {
+    for (int k = 0; k < BATCH_NUM_ALGORITHMS; k++)
+        if (strcmp(name, batch_algorithms[k]) == 0) return k;
+    return -1;
 }
 
-// Fonction pour libérer la mémoire d'une matrice n x n
-void free_matrix(int **mat, int n) {
-    for (int i = 0; i < n; i++) { // Boucle sur chaque ligne de la matrice
-        free(mat[i]);            // Libère la mémoire de la ligne i
+// Écrit s entre guillemets, avec les échappements JSON
+static void batch_print_string(const char *s) {
+    putchar('"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (c < ' ') printf("\\u%04x", c);
+        else putchar(c);
     }
-    free(mat); // Libère le tableau de pointeurs
+    putchar('"');
 }
 
-// Fonction pour afficher une matrice n x n avec un titre
-void print_matrix(int **mat, int n, const char *title) {
-    printf("%s\n", title);              // Affiche le titre
-    for (int i = 0; i < n; i++) {       // Parcourt chaque ligne
-        for (int j = 0; j < n; j++) {   // Parcourt chaque colonne
-            printf("%4d ", mat[i][j]);  // Affiche la valeur mat[i][j] avec un espacement
-        }
-        printf("\n");                  // Retour à la ligne après chaque ligne de la matrice
-    }
-    printf("\n");                       // Ligne vide après la matrice
+static void batch_print_error(const char *filename, const char *algorithm, const char *message) {
+    printf("{\"file\": ");
+    batch_print_string(filename);
+    printf(", \"algorithm\": ");
+    batch_print_string(algorithm);
+    printf(", \"error\": ");
+    batch_print_string(message);
+    printf("}\n");
+    fflush(stdout);
 }
 
-// Fonction pour lire les données du fichier d'entrée dans la structure FlowNetwork
-int read_input_file(const char *filename, FlowNetwork *G) {
-    FILE *f = fopen(filename, "r");             // Ouvre le fichier en lecture
-    if (!f) {                                   // Si f est NULL, erreur d'ouverture
-        fprintf(stderr, "Impossible d'ouvrir le fichier %s. Vérifiez le nom et réessayez.\n", filename); // Message d'erreur plus clair
-        return 0;                               // Retourne 0 pour indiquer l'échec, ce qui permettra de redemander un nom de fichier
+// Tâche sur un fichier grille (algorithme bk seulement)
+static void batch_run_grid(const char *filename, const char *algorithm, int algo) {
+    if (algo != BATCH_GRID) {
+        batch_print_error(filename, algorithm, "fichier grille : algorithme bk uniquement");
+        return;
     }
-
-    fscanf(f, "%d", &(G->n));        // Lit le nombre de sommets n
-    G->capacity = allocate_matrix(G->n); // Alloue la matrice de capacités de taille n x n
-
-    for (int i = 0; i < G->n; i++) {     // Boucle sur chaque ligne de la matrice de capacités
-        for (int j = 0; j < G->n; j++) { // Boucle sur chaque colonne
-            fscanf(f, "%d", &(G->capacity[i][j])); // Lit la capacité c(i,j) depuis le fichier
-        }
+    GridNetwork G;
+    double start = batch_now();
+    if (!read_grid_file(filename, &G)) {
+        batch_print_error(filename, algorithm, "lecture impossible");
+        return;
     }
-
-    int c = fgetc(f);                              // Lit un caractère pour voir s'il y a plus de données
-    while (c == ' ' || c == '\n' || c == '\r' || c == '\t') c = fgetc(f); // Ignore les espaces et sauts de ligne
-    if (c != EOF) {                                // S'il y a encore des données dans le fichier
-        ungetc(c, f);                              // Replace le caractère lu
-        G->cost = allocate_matrix(G->n);            // Alloue la matrice de coûts n x n
-        for (int i = 0; i < G->n; i++) {            // Parcourt chaque ligne de la matrice de coûts
-            for (int j = 0; j < G->n; j++) {        // Parcourt chaque colonne
-                fscanf(f, "%d", &(G->cost[i][j]));  // Lit le coût d(i,j)
-            }
-        }
-        G->isMinCost = 1;                           // Indique qu'il s'agit d'un problème de flot à coût min
+    double load_seconds = batch_now() - start;
+    G.source_side = (unsigned char *)malloc(G.cells);
+    start = batch_now();
+    flow_sum_t flow = G.source_side ? grid_max_flow(&G) : -1;
+    double solve_seconds = batch_now() - start;
+    if (flow < 0) {
+        batch_print_error(filename, algorithm, "mémoire insuffisante");
     } else {
-        G->isMinCost = 0;                           // Pas de matrice de coûts
-        G->cost = NULL;                             // cost reste NULL
+        int source_cells = 0;
+        for (int i = 0; i < G.cells; i++) source_cells += G.source_side[i];
+        printf("{\"file\": ");
+        batch_print_string(filename);
+        printf(", \"algorithm\": \"%s\", \"cells\": %d, \"flow\": %lld, \"source_cells\": %d", algorithm, G.cells, flow, source_cells);
+        printf(", \"load_s\": %.9f, \"solve_s\": %.9f}\n", load_seconds, solve_seconds);
+        fflush(stdout);
     }
-
-    G->s = 0;                   // Définition de la source s=0
-    G->t = G->n - 1;            // Définition du puits t=n-1
-
-    fclose(f);                  // Ferme le fichier
-    return 1;                   // Retourne 1 pour indiquer le succès
+    free(G.source_side);
+    free_grid_network(&G);
 }
 
-// Fonction auxiliaire : BFS utilisée par Edmond-Karp pour trouver un chemin augmentant
-int bfs_edmond_karp(int n, int **residual, int s, int t, int parent[]) {
-    int *visited = (int *)calloc(n, sizeof(int)); // Tableau visited initialisé à 0
-    for (int i = 0; i < n; i++)
-        parent[i] = -1;        // Initialise parent[] à -1
-
-    visited[s] = 1;            // Marque la source comme visitée
-    parent[s] = -1;            // La source n'a pas de parent
-
-    int *queue = (int *)malloc(n * sizeof(int));  // File pour la BFS
-    int front = 0, rear = 0;                      // Indices de la file
-    queue[rear++] = s;                            // Enfile la source
-
-    while (front < rear) {          // Tant que la file n'est pas vide
-        int u = queue[front++];     // Défile un sommet u
-        for (int v = 0; v < n; v++) {           // Parcourt tous les sommets v
-            if (!visited[v] && residual[u][v] > 0) { // Si non visité et capacité résiduelle > 0
-                queue[rear++] = v;                // Enfile v
-                parent[v] = u;                    // Met à jour le parent de v
-                visited[v] = 1;                   // Marque v comme visité
-                if (v == t) {                     // Si on a atteint le puits
-                    free(queue);                  // Libère la file
-                    free(visited);                // Libère visited
-                    return 1;                     // Chemin trouvé
-                }
-            }
-        }
+// Exécute une tâche. desired_flow < 0 : flot imposé par le fichier s'il y en a un, sinon flot maximal.
+static void batch_run(BatchState *B, const char *filename, const char *algorithm, flow_sum_t desired_flow) {
+    int algo = batch_find_algorithm(algorithm);
+    if (algo < 0) {
+        batch_print_error(filename, algorithm, "algorithme inconnu");
+        return;
     }
-    free(queue);   // Libère la file si pas de chemin
-    free(visited); // Libère visited
-    return 0;       // Aucun chemin trouvé
-}
-
-// Algorithme Ford-Fulkerson (Edmond-Karp) pour trouver le flot max
-int ford_fulkerson(FlowNetwork *G) {
-    int n = G->n;                                   // Récupère le nombre de sommets
-    int **residual = allocate_matrix(n);            // Alloue le graphe résiduel
-    for (int i = 0; i < n; i++) {                   // Copie des capacités dans residual
-        for (int j = 0; j < n; j++) {
-            residual[i][j] = G->capacity[i][j];     // Initialisation du graphe résiduel = capacités
-        }
+    if (is_grid_file(filename)) {
+        batch_run_grid(filename, algorithm, algo);
+        return;
     }
-
-    int *parent = (int *)malloc(n * sizeof(int));   // Tableau pour stocker le chemin BFS
-    int max_flow = 0;                               // Flot maximal initialisé à 0
-
-    // Tant qu'un chemin augmentant existe
-    while (bfs_edmond_karp(n, residual, G->s, G->t, parent)) {
-        int path_flow = INT_MAX;                    // Flot possible sur ce chemin
-        for (int v = G->t; v != G->s; v = parent[v]) { // Remonte le chemin trouvé
-            int u = parent[v];                      // u est le parent de v dans le chemin
-            if (residual[u][v] < path_flow)
-                path_flow = residual[u][v];         // Trouve le minimum résiduel sur le chemin
+    if (algo == BATCH_GRID) {
+        batch_print_error(filename, algorithm, "algorithme réservé aux fichiers grille");
+        return;
+    }
+    B->load_seconds = 0.0;
+    if (strcmp(B->filename, filename) != 0) {   // Nouveau fichier : le graphe précédent est libéré
+        if (B->filename[0]) {
+            flow_solver_free(&B->solver);
+            free_flow_network(&B->G);
         }
-
-        for (int v = G->t; v != G->s; v = parent[v]) { // Met à jour le graphe résiduel
-            int u = parent[v];
-            residual[u][v] -= path_flow;            // Réduit la capacité résiduelle dans le sens u->v
-            residual[v][u] += path_flow;            // Augmente la résiduelle dans l'autre sens v->u
+        B->filename[0] = '\0';
+        double start = batch_now();
+        if (strlen(filename) >= sizeof(B->filename) || !read_input_file(filename, &B->G)) {
+            batch_print_error(filename, algorithm, "lecture impossible");
+            return;
         }
-
-        printf("Chemin augmentant trouvé avec flot = %d\n", path_flow); // Affiche le flot trouvé sur le chemin
-        max_flow += path_flow;                     // Ajoute path_flow au flot max total
-    }
-
-    free(parent);           // Libère parent
-    free_matrix(residual, n); // Libère le graphe résiduel
-    return max_flow;        // Retourne le flot maximal
-}
-
-// push_func : fonction pour pousser du flot de u vers v dans l'algorithme Push-Relabel
-static void push_func(int u, int v, int n, int **residual, int *excess) {
-    int send = (excess[u] < residual[u][v]) ? excess[u] : residual[u][v]; // On envoie le min(excess[u],residual[u][v])
-    residual[u][v] -= send;      // Réduit la résiduelle u->v
-    residual[v][u] += send;      // Augmente la résiduelle v->u
-    excess[u] -= send;           // Réduit l'excès de u
-    excess[v] += send;           // Augmente l'excès de v
-    // Au lieu de "Push de %d unités de %d vers %d", on affiche en français :
-    printf("Envoi de %d unités de flot du sommet %d vers le sommet %d\n", send, u+1, v+1); // Affiche l'action d'envoi
-}
-
-// relabel_func : fonction pour réétiqueter (augmenter la hauteur du sommet u)
-static void relabel_func(int u, int n, int **residual, int *height) {
-    int mh = INT_MAX;                      // mh = hauteur minimale parmi les voisins admissibles
-    for (int v = 0; v < n; v++) {          // Parcourt tous les voisins v
-        if (residual[u][v] > 0 && height[v] < mh) { // Si arête résiduelle u->v positive et height[v] plus petite
-            mh = height[v];                // Met à jour mh
+        if (!flow_solver_init(&B->solver, &B->G)) {
+            batch_print_error(filename, algorithm, "mémoire insuffisante");
+            free_flow_network(&B->G);
+            return;
         }
+        B->load_seconds = batch_now() - start;
+        strcpy(B->filename, filename);
     }
-    if (mh < INT_MAX) {
-        height[u] = mh + 1;                // Augmente la hauteur de u
-        // Au lieu de "Relabel du sommet ...", on affiche la version française :
-        printf("Réétiquetage du sommet %d, nouvelle hauteur = %d\n", u+1, height[u]); // Affiche l'action de réétiquetage
+    FlowNetwork *G = &B->G;
+    FlowSolver *S = &B->solver;
+    int min_cost = algo >= BATCH_FIRST_MIN_COST;
+    if (min_cost && !G->cost) {
+        batch_print_error(filename, algorithm, "pas de coûts dans ce fichier");
+        return;
     }
-}
-
-// Algorithme pousser-réétiqueter (Push-Relabel) pour le flot max
-int push_relabel(FlowNetwork *G) {
-    int n = G->n;                                  // Nombre de sommets
-    int **capacity = G->capacity;                  // Raccourci vers la matrice des capacités
-
-    int **residual = allocate_matrix(n);           // Alloue le graphe résiduel
-    for (int i = 0; i < n; i++)
-        for (int j = 0; j < n; j++)
-            residual[i][j] = capacity[i][j];       // Copie des capacités dans residual
+    if (min_cost && desired_flow < 0)
+        desired_flow = G->demand > 0 ? G->demand : dinic(S);
 
-    int *height = (int *)calloc(n, sizeof(int));   // Tableau des hauteurs, init à 0
-    int *excess = (int *)calloc(n, sizeof(int));   // Tableau des excès, init à 0
-    int *seen = (int *)calloc(n, sizeof(int));     // Tableau vu, pas forcément utilisé ici
-
-    height[G->s] = n;                              // Hauteur de la source = n
-    for (int v = 0; v < n; v++) {                  // Pousse immédiatement depuis la source
-        if (residual[G->s][v] > 0) {
-            excess[v] = residual[G->s][v];         // L'excès du voisin v = la capacité s->v
-            residual[v][G->s] = residual[G->s][v]; // Résiduel inverse
-            residual[G->s][v] = 0;                 // On a poussé tout le flot possible
-        }
+    G->arc_flow = (flow_cap_t *)malloc((G->m > 0 ? G->m : 1) * sizeof(flow_cap_t));
+    if (!G->arc_flow) {
+        batch_print_error(filename, algorithm, "mémoire insuffisante");
+        return;
     }
-
-    while (1) {
-        int done = 1;                      // Indicateur si aucune action n'est effectuée
-        for (int u = 0; u < n; u++) {      // Parcourt tous les sommets
-            if (u != G->s && u != G->t && excess[u] > 0) { // Si u a de l'excès (hors s,t)
-                done = 0;                                  // On va tenter quelque chose
-                for (int v = 0; v < n && excess[u] > 0; v++) { // Essaye de pousser vers les voisins
-                    if (residual[u][v] > 0 && height[u] == height[v] + 1) {
-                        push_func(u, v, n, residual, excess); // Pousse si admissible
-                    }
-                }
-                if (excess[u] > 0) {        // Si après tentative de push, excès > 0
-                    relabel_func(u, n, residual, height); // On relabel u
-                }
-            }
-        }
-        if (done)                           // Si done = 1, aucune action, on s'arrête
-            break;
+    flow_sum_t cost_total;
+    double start = batch_now();
+    switch (algo) {
+    case 0: ford_fulkerson(S); break;
+    case 1: push_relabel(S); break;
+    case 2: dinic(S); break;
+    case 3: push_relabel_highest_label(S); break;
+    case 4: push_relabel_parallel(S, 0); break;
+    case 5: capacity_scaling(S); break;
+    case 7: min_cost_flow(S, desired_flow); break;
+    case 8: min_cost_flow_dijkstra(S, desired_flow, &cost_total); break;
+    default: network_simplex(S, desired_flow, &cost_total); break;
     }
-
-    int max_flow = excess[G->t];            // Le flot max est l'excès au puits
-    free(height);                           // Libère height
-    free(excess);                           // Libère excess
-    free(seen);                             // Libère seen
-    free_matrix(residual, n);               // Libère le graphe résiduel
-    return max_flow;                        // Retourne le flot max
+    double solve_seconds = batch_now() - start;
+
+    flow_sum_t flow = 0, cost = 0;              // Recalculés à partir du flot de chaque arc direct
+    for (int a = G->first[G->s]; a < G->first[G->s + 1]; a++)
+        if (G->capacity[a] > 0) flow += G->arc_flow[a];
+        else flow -= G->arc_flow[G->rev[a]];
+    if (min_cost) cost = flow_cost_of(G, G->arc_flow);
+    free(G->arc_flow);
+    G->arc_flow = NULL;
+
+    printf("{\"file\": ");
+    batch_print_string(filename);
+    printf(", \"algorithm\": \"%s\", \"n\": %d, \"arcs\": %d, \"flow\": %lld", algorithm, G->n, G->m / 2, flow);
+    if (min_cost) printf(", \"desired_flow\": %lld, \"cost\": %lld", desired_flow, cost);
+    printf(", \"load_s\": %.9f, \"solve_s\": %.9f", B->load_seconds, solve_seconds);
+    for (int k = 0; k < FLOW_STAT_COUNT; k++)   // Compteurs de la résolution (FlowStats)
+        printf(", \"%s\": %lld", flow_stat_names[k], S->stats.count[k]);
+    printf("}\n");
+    fflush(stdout);                             // Le script qui pilote le processus lit chaque résultat aussitôt
 }
 
-// Bellman-Ford pour trouver un plus court chemin en coût dans le graphe résiduel
-int bellman_ford(int n, int **capacity, int **cost, int **residual_cap, int **residual_cost, int s, int t, int *parent) {
-    int *dist = (int *)malloc(n * sizeof(int)); // Tableau des distances
-    for (int i = 0; i < n; i++) {
-        dist[i] = INT_MAX;          // Distance initiale = infinie
-        parent[i] = -1;             // Pas de parent au début
-    }
-    dist[s] = 0;                     // Distance à la source = 0
-
-    for (int k = 0; k < n-1; k++) {  // Relaxation n-1 fois
-        for (int u = 0; u < n; u++) {
-            for (int v = 0; v < n; v++) {
-                if (residual_cap[u][v] > 0 && dist[u] != INT_MAX && dist[u] + residual_cost[u][v] < dist[v]) {
-                    dist[v] = dist[u] + residual_cost[u][v]; // Mise à jour de la distance
-                    parent[v] = u;                            // Mise à jour du parent
-                }
-            }
+// Lit les tâches de f, une par ligne : "fichier algorithme [flot]" (lignes vides et # ignorées)
+static void batch_read_jobs(BatchState *B, FILE *f) {
+    char line[8192], filename[4096], algorithm[64];
+    while (fgets(line, sizeof(line), f)) {
+        flow_sum_t desired_flow = -1;
+        int fields = sscanf(line, "%4095s %63s %lld", filename, algorithm, &desired_flow);
+        if (fields <= 0 || filename[0] == '#') continue;
+        if (fields == 1) {
+            batch_print_error(filename, "", "ligne incomplète (fichier algorithme [flot])");
+            continue;
         }
+        batch_run(B, filename, algorithm, desired_flow);
     }
-
-    printf("Table de Bellman-Ford (dist):\n"); // Affiche les distances trouvées
-    for (int i = 0; i < n; i++) {
-        if (dist[i] == INT_MAX) printf("  INF");  // Affiche INF si inaccessible
-        else printf("%5d", dist[i]);              // Sinon affiche la distance
-    }
-    printf("\n");
-
-    int reachable = (dist[t] != INT_MAX); // 1 si t est accessible, 0 sinon
-    free(dist);                           // Libère dist
-    return reachable;                     // Retourne reachable
 }
 
-// Flot à coût minimal pour un flot donné desired_flow
-int min_cost_flow(FlowNetwork *G, int desired_flow) {
-    int n = G->n;                                         // Nombre de sommets
-    int **residual_cap = allocate_matrix(n);              // Graphe résiduel pour les capacités
-    int **residual_cost = allocate_matrix(n);             // Graphe résiduel pour les coûts
+static void batch_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage : %s                                  (mode interactif)\n"
+            "        %s -a algos [-v flot] fichiers...   (chaque fichier avec chaque algorithme)\n"
+            "        %s -l liste|-                       (tâches \"fichier algorithme [flot]\", une par ligne)\n"
+            "  -a  algorithmes séparés par des virgules : ff, pr, dinic, prhl, ppr, cs, min, dij, ns,\n"
+            "      ou bk pour un fichier grille (grid nx ny [nz], une ligne de capacités par cellule)\n"
+            "  -v  flot désiré des algorithmes à coût minimal (défaut : offres du fichier, sinon flot maximal)\n"
+            "  -l  liste de tâches (- : entrée standard, lue au fil de l'eau)\n"
+            "Chaque tâche écrit une ligne JSON : flot, coût, temps de chargement et de résolution, compteurs du solveur.\n",
+            prog, prog, prog);
+}
 
-    for (int i = 0; i < n; i++) {                         // Initialisation du graphe résiduel
-        for (int j = 0; j < n; j++) {
-            residual_cap[i][j] = G->capacity[i][j];       // Copie des capacités
-            residual_cost[i][j] = G->cost[i][j];          // Copie des coûts
+// Mode lot (appelé quand le programme reçoit des arguments). Retourne le code de sortie.
+static int batch_main(int argc, char **argv) {
+    const char *algorithms = NULL, *list = NULL;
+    flow_sum_t desired_flow = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "a:v:l:h")) != -1) {
+        switch (opt) {
+        case 'a': algorithms = optarg; break;
+        case 'v': desired_flow = atoll(optarg); break;
+        case 'l': list = optarg; break;
+        default:
+            batch_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
         }
     }
+    if (!list && (!algorithms || optind >= argc)) {
+        batch_usage(argv[0]);
+        return 1;
+    }
 
-    int *parent = (int *)malloc(n * sizeof(int));          // Tableau parent pour Bellman-Ford
-    int flow = 0;                                          // Flot actuel = 0
-    int cost_total = 0;                                    // Coût total = 0
-
-    while (flow < desired_flow) {                          // Tant qu'on n'a pas atteint le flot désiré
-        if (!bellman_ford(n, G->capacity, G->cost, residual_cap, residual_cost, G->s, G->t, parent))
-            break; // Pas de chemin augmentant de coût minimal si Bellman-Ford échoue
-
-        int path_flow = desired_flow - flow;               // On peut envoyer au plus (desired_flow - flow)
-        for (int v = G->t; v != G->s; v = parent[v]) {     // Trouve le max de flot possible sur ce chemin
-            int u = parent[v];
-            if (residual_cap[u][v] < path_flow)
-                path_flow = residual_cap[u][v];            // min sur le chemin
-        }
-
-        for (int v = G->t; v != G->s; v = parent[v]) {     // Met à jour le graphe résiduel
-            int u = parent[v];
-            residual_cap[u][v] -= path_flow;               // Réduit la capacité résiduelle u->v
-            residual_cap[v][u] += path_flow;               // Augmente la résiduelle v->u
-            cost_total += path_flow * residual_cost[u][v]; // Ajoute le coût
+    BatchState B;
+    B.filename[0] = '\0';
+    trace_set_level(TRACE_NONE);                // Aucune trace ni message des solveurs sur la sortie standard
+    for (int i = optind; algorithms && i < argc; i++) {
+        char names[256];
+        snprintf(names, sizeof(names), "%s", algorithms);
+        for (char *name = strtok(names, ","); name; name = strtok(NULL, ","))
+            batch_run(&B, argv[i], name, desired_flow);
+    }
+    if (list) {
+        FILE *f = strcmp(list, "-") == 0 ? stdin : fopen(list, "r");
+        if (!f) {
+            fprintf(stderr, "Impossible d'ouvrir %s.\n", list);
+        } else {
+            batch_read_jobs(&B, f);
+            if (f != stdin) fclose(f);
         }
-
-        printf("Chaîne augmentante trouvée, flot = %d\n", path_flow); // Affiche le flot sur ce chemin
-        flow += path_flow;                                  // Met à jour le flot total
     }
-
-    if (flow < desired_flow) {                              // Si on n'a pas atteint le flot désiré
-        printf("Impossible d'atteindre le flot désiré.\n");
-    } else {
-        printf("Flot atteint = %d, Coût total = %d\n", flow, cost_total); // Affiche le flot et le coût total
+    if (B.filename[0]) {
+        flow_solver_free(&B.solver);
+        free_flow_network(&B.G);
     }
-
-    free(parent);                       // Libère parent
-    free_matrix(residual_cap, n);       // Libère residual_cap
-    free_matrix(residual_cost, n);      // Libère residual_cost
-    return 0;                           // Retourne 0
+    return 0;
 }
 
 // Fonction main : point d'entrée du programme
-int main() {
+int main(int argc, char **argv) {
     FlowNetwork G;                                // Déclare une structure FlowNetwork
+    FlowSolver S;                                 // Tableaux de travail des solveurs pour G
     char filename[256];                           // Tableau pour stocker le nom du fichier
+    const char *level = getenv("FLOW_TRACE_LEVEL"); // Niveau de trace (0 à 3), détaillé par défaut
+    trace_set_level(level ? atoi(level) : TRACE_STEPS);
+    const char *bfs_threads = getenv("FLOW_BFS_THREADS"); // Threads des parcours en largeur (0 = un par cœur)
+    if (bfs_threads) bfs_set_threads(atoi(bfs_threads));
+    const char *simd = getenv("FLOW_SIMD");       // Jeu d'instructions maximal : 0 scalaire, 1 AVX2, 2 AVX-512
+    if (simd) simd_set_level(atoi(simd));
+    const char *reduce = getenv("FLOW_REDUCE");   // 0 : résout le graphe du fichier sans le réduire
+    if (reduce) reduction_set_enabled(atoi(reduce));
+    if (argc > 1) return batch_main(argc, argv); // Mode lot : tâches en arguments ou dans une liste
+    char solution[272];                           // Nom du fichier solution d'une entrée DIMACS
 
     while (1) {                                   // Boucle infinie jusqu'à ce que l'utilisateur entre "0"
         printf("Entrez le nom du fichier (ou 0 pour quitter) : "); // Demande le nom du fichier
@@ -325,47 +271,146 @@ int main() {
         }
         if (strcmp(filename, "0") == 0) break;     // Si l'utilisateur tape "0", on quitte la boucle
 
+        if (is_grid_file(filename)) {              // Grille implicite : Boykov-Kolmogorov, sans graphe CSR
+            GridNetwork grid;
+            if (!read_grid_file(filename, &grid)) continue;
+            printf("Grille %d x %d x %d : %d cellules\n", grid.nx, grid.ny, grid.nz, grid.cells);
+            grid.source_side = (unsigned char *)malloc(grid.cells);
+            flow_sum_t max_flow = grid.source_side ? grid_max_flow(&grid) : -1;
+            if (max_flow < 0) {
+                fprintf(stderr, "Mémoire insuffisante.\n");
+            } else {
+                int source_cells = 0;
+                for (int i = 0; i < grid.cells; i++) source_cells += grid.source_side[i];
+                printf("Flot maximal trouvé = %lld\n", max_flow);
+                printf("Cellules du côté source de la coupe minimale : %d\n", source_cells);
+            }
+            free(grid.source_side);
+            free_grid_network(&grid);
+            continue;
+        }
+
         if (!read_input_file(filename, &G)) {      // Lit les données du fichier dans G
             // Si lecture ou ouverture échoue, on continue la boucle pour redemander un fichier
             continue;
         }
+        if (!flow_solver_init(&S, &G)) {
+            fprintf(stderr, "Mémoire insuffisante.\n");
+            free_flow_network(&G);
+            continue;
+        }
+        if (S.G != &G)                             // Réduction faite par flow_solver_init (hors traces détaillées)
+            printf("Graphe réduit : %d arcs au lieu de %d\n", S.G->m / 2, G.m / 2);
 
-        print_matrix(G.capacity, G.n, "Matrice des Capacités:"); // Affiche la matrice des capacités
-        if (G.isMinCost) {                         // Si flot à coût min
-            print_matrix(G.cost, G.n, "Matrice des Coûts:"); // Affiche la matrice des coûts
+        int dimacs = is_dimacs_file(filename);     // Entrée DIMACS : pas de matrices, solution écrite dans <fichier>.sol
+        if (dimacs) {
+            G.arc_flow = (flow_cap_t *)malloc((G.m > 0 ? G.m : 1) * sizeof(flow_cap_t));
+            printf("Graphe DIMACS : %d sommets, %d arcs\n", G.input_nodes, G.m / 2);
+        } else {
+            print_matrix(&G, G.capacity, "Matrice des Capacités:"); // Affiche la matrice des capacités
+            if (G.isMinCost) {                     // Si flot à coût min
+                print_cost_matrix(&G, "Matrice des Coûts:"); // Affiche la matrice des coûts
+            }
         }
 
         if (!G.isMinCost) {                        // Si problème de flot max
             int choix_algo;                        // Variable pour stocker le choix de l'algorithme
             // Au lieu d'afficher "Pousser-Relabeller", on met "Pousser-Réétiqueter"
-            printf("Choisissez l'algorithme de flot max:\n1 - Ford-Fulkerson (Edmond-Karp)\n2 - Pousser-Réétiqueter\nVotre choix: ");
+            printf("Choisissez l'algorithme de flot max:\n1 - Ford-Fulkerson (Edmond-Karp)\n2 - Pousser-Réétiqueter\n3 - Dinic\n4 - Pousser-Réétiqueter (plus haute étiquette)\n5 - Pousser-Réétiqueter parallèle\n6 - Ford-Fulkerson incrémental (modifications de capacités)\n7 - Ford-Fulkerson avec mise à l'échelle des capacités\nVotre choix: ");
             if (scanf("%d", &choix_algo) != 1) {   // Lit le choix
                 fprintf(stderr, "Entrée invalide.\n");
+                free(G.arc_flow);
+                flow_solver_free(&S);
+                free_flow_network(&G);
                 continue;                           // Recommence la boucle
             }
-            int max_flow;                           // Variable pour stocker le flot max
+            flow_sum_t max_flow;                    // Variable pour stocker le flot max
             if (choix_algo == 1) {                  // Si choix = 1
-                max_flow = ford_fulkerson(&G);      // Appelle ford_fulkerson
+                max_flow = ford_fulkerson(&S);      // Appelle ford_fulkerson
+            } else if (choix_algo == 3) {           // Si choix = 3
+                max_flow = dinic(&S);               // Appelle dinic
+            } else if (choix_algo == 4) {           // Si choix = 4
+                max_flow = push_relabel_highest_label(&S); // Appelle la variante plus haute étiquette
+            } else if (choix_algo == 5) {           // Si choix = 5
+                max_flow = push_relabel_parallel(&S, 0); // Un thread par cœur
+            } else if (choix_algo == 7) {           // Si choix = 7
+                max_flow = capacity_scaling(&S);    // Chemins augmentants par seuils delta décroissants
+            } else if (choix_algo == 6) {           // Si choix = 6 : flot conservé entre les modifications
+                IncrementalFlow F;
+                max_flow = incremental_flow_init(&F, &G);
+                int base = dimacs ? 1 : 0;          // Sommets numérotés comme dans le fichier
+                int u, v;
+                flow_sum_t delta;
+                if (max_flow < 0) fprintf(stderr, "Mémoire insuffisante.\n");
+                else printf("Flot maximal initial = %lld\n", max_flow);
+                while (max_flow >= 0) {
+                    printf("Modification (u v delta, ou 0 0 0 pour terminer) : ");
+                    if (scanf("%d %d %lld", &u, &v, &delta) != 3 || (u == 0 && v == 0 && delta == 0)) break;
+                    int a = flow_find_arc(&G, u - base, v - base);
+                    if (a < 0) {
+                        printf("Pas d'arc %d -> %d dans le graphe.\n", u, v);
+                        continue;
+                    }
+                    max_flow = incremental_flow_update(&F, 1, &a, &delta);
+                    printf("Flot maximal après modification = %lld\n", max_flow);
+                }
+                if (max_flow >= 0) incremental_flow_free(&F);
             } else {
-                max_flow = push_relabel(&G);        // Sinon appelle push_relabel
+                max_flow = push_relabel(&S);        // Sinon appelle push_relabel
+            }
+            printf("Flot maximal trouvé = %lld\n", max_flow); // Affiche le flot max
+            if (dimacs) {
+                snprintf(solution, sizeof(solution), "%s.sol", filename);
+                if (write_dimacs_solution(solution, &G, G.arc_flow, max_flow))
+                    printf("Solution écrite dans %s\n", solution);
             }
-            printf("Flot maximal trouvé = %d\n", max_flow); // Affiche le flot max
         } else {
             // Si problème de flot à coût min
-            int val_flot;                           // Valeur du flot désiré
-            printf("Entrez la valeur de flot désirée: ");
-            if (scanf("%d", &val_flot) != 1) {      // Lit val_flot
+            flow_sum_t val_flot;                    // Valeur du flot désiré
+            if (dimacs || G.demand > 0) {
+                val_flot = G.demand;                // Fixée par les offres du fichier (DIMACS ou sa conversion binaire)
+                printf("Flot imposé par les offres : %lld\n", val_flot);
+            } else {
+                printf("Entrez la valeur de flot désirée: ");
+                if (scanf("%lld", &val_flot) != 1) { // Lit val_flot
+                    fprintf(stderr, "Entrée invalide.\n");
+                    free(G.arc_flow);
+                    flow_solver_free(&S);
+                    free_flow_network(&G);
+                    continue;                       // Recommence la boucle
+                }
+            }
+            int choix_min;                          // Choix de l'algorithme de flot à coût min
+            printf("Choisissez l'algorithme de flot à coût min:\n1 - Bellman-Ford\n2 - Dijkstra avec potentiels\n3 - Simplexe des réseaux\nVotre choix: ");
+            if (scanf("%d", &choix_min) != 1) {     // Lit le choix
                 fprintf(stderr, "Entrée invalide.\n");
+                free(G.arc_flow);
+                flow_solver_free(&S);
+                free_flow_network(&G);
                 continue;                           // Recommence la boucle
             }
-            min_cost_flow(&G, val_flot);            // Lance l'algorithme de flot à coût min
+            if (choix_min == 2) {                   // Si choix = 2
+                flow_sum_t cost_total;
+                min_cost_flow_dijkstra(&S, val_flot, &cost_total); // Dijkstra avec potentiels de Johnson
+            } else if (choix_min == 3) {            // Si choix = 3
+                flow_sum_t cost_total;
+                network_simplex(&S, val_flot, &cost_total); // Simplexe des réseaux
+            } else {
+                min_cost_flow(&S, val_flot);        // Lance l'algorithme de flot à coût min
+            }
+            if (dimacs) {                           // Le coût est recalculé à partir du flot de chaque arc
+                flow_sum_t total = flow_cost_of(&G, G.arc_flow);
+                snprintf(solution, sizeof(solution), "%s.sol", filename);
+                if (write_dimacs_solution(solution, &G, G.arc_flow, total))
+                    printf("Solution écrite dans %s\n", solution);
+            }
         }
 
-        free_matrix(G.capacity, G.n);               // Libère la matrice des capacités
-        if (G.isMinCost) {                          // Si flot à coût min, libère aussi la matrice de coûts
-            free_matrix(G.cost, G.n);
-        }
+        free(G.arc_flow);                           // NULL hors DIMACS
+        flow_solver_free(&S);                       // Libère les tableaux de travail
+        free_flow_network(&G);                      // Libère le graphe (capacités et coûts)
     }
 
+    trace_set_level(TRACE_NONE);                    // Libère le tampon de trace
     return 0; // Retourne 0 pour indiquer que le programme s'est terminé normalement
-}
\ No newline at end of file
+}
@@ -1,396 +1,656 @@
-#include <stdio.h>      // Inclusion de la bibliothèque standard d'entrée/sortie
-#include <stdlib.h>     // Inclusion de la bibliothèque standard pour malloc, free, etc.
-#include <string.h>     // Inclusion de la bibliothèque pour strcmp, etc.
-#include <limits.h>     // Inclusion de la bibliothèque pour INT_MAX
+#define _GNU_SOURCE    // sched_getcpu et CPU_SET (placement des threads du benchmark)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
-
-// Définition d'une structure FlowNetwork pour représenter un réseau de flot
+#include <unistd.h>     // getopt, sysconf
+#include <pthread.h>    // Mesures en parallèle
+#include <sched.h>      // Placement des threads sur les cœurs
+#include <stdint.h>
+#include <sys/ioctl.h>  // Commandes des compteurs matériels
+#include <sys/syscall.h> // perf_event_open n'a pas d'enveloppe dans la libc
+#include <linux/perf_event.h>
+#include "flow.h"       // Graphes, fichiers et solveurs (bibliothèque commune)
+
+// Banc d'essai : chaque instance est chargée une seule fois, chaque algorithme est d'abord lancé
+// quelques fois sans mesure (mise en température des caches), puis chronométré rep fois avec une
+// horloge monotone. On rapporte min, médiane, p95, p99, max et le débit (arcs traités par seconde),
+// ainsi que la médiane des compteurs du solveur (FlowStats) et, avec -P, des compteurs matériels.
+
+// Algorithmes mesurables : nom court (option -a), puis indicateur "nécessite des coûts"
 typedef struct {
-    int n;              // Nombre de sommets dans le réseau
-    int **capacity;     // Pointeur sur une matrice des capacités (n x n)
-    int **cost;         // Pointeur sur une matrice des coûts (n x n), NULL si pas de coûts
-    int s, t;           // Indices de la source (s) et du puits (t)
-    int isMinCost;      // Indicateur (0 ou 1) pour savoir si c'est un problème de flot max (0) ou min (1)
-} FlowNetwork;
-
-// Fonction pour allouer une matrice n x n d'entiers et l'initialiser à 0
-int **allocate_matrix(int n) {
-    int **mat = (int **)malloc(n * sizeof(int *)); // Alloue un tableau de n pointeurs vers des int*
-    for (int i = 0; i < n; i++) {                   // Boucle sur chaque ligne
-        mat[i] = (int *)calloc(n, sizeof(int));     // Alloue et initialise à 0 une ligne de n int
+    const char *name;       // Nom utilisé en ligne de commande et dans les résultats
+    const char *label;      // Nom affiché
+    int needs_cost;         // 1 : flot à coût minimal, sauté si l'instance n'a pas de coûts
+    flow_sum_t (*run)(FlowSolver *S, flow_sum_t desired_flow); // Retourne le flot obtenu
+} BenchAlgorithm;
+
+static flow_sum_t bench_ff(FlowSolver *S, flow_sum_t desired_flow) { (void)desired_flow; return ford_fulkerson(S); }
+static flow_sum_t bench_pr(FlowSolver *S, flow_sum_t desired_flow) { (void)desired_flow; return push_relabel(S); }
+static flow_sum_t bench_dinic(FlowSolver *S, flow_sum_t desired_flow) { (void)desired_flow; return dinic(S); }
+static flow_sum_t bench_prhl(FlowSolver *S, flow_sum_t desired_flow) { (void)desired_flow; return push_relabel_highest_label(S); }
+static flow_sum_t bench_min(FlowSolver *S, flow_sum_t desired_flow) { min_cost_flow(S, desired_flow); return desired_flow; }
+static flow_sum_t bench_dij(FlowSolver *S, flow_sum_t desired_flow) { flow_sum_t cost; return min_cost_flow_dijkstra(S, desired_flow, &cost); }
+static flow_sum_t bench_ns(FlowSolver *S, flow_sum_t desired_flow) { flow_sum_t cost; return network_simplex(S, desired_flow, &cost); }
+static int bench_solver_threads = 0;   // Threads de Pousser-Réétiqueter parallèle (option -t, 0 = un par cœur)
+static flow_sum_t bench_ppr(FlowSolver *S, flow_sum_t desired_flow) { (void)desired_flow; return push_relabel_parallel(S, bench_solver_threads); }
+static flow_sum_t bench_cs(FlowSolver *S, flow_sum_t desired_flow) { (void)desired_flow; return capacity_scaling(S); }
+
+static const BenchAlgorithm bench_algorithms[] = {
+    {"ff",    "Ford-Fulkerson",                          0, bench_ff},
+    {"pr",    "Pousser-Réétiqueter",                     0, bench_pr},
+    {"min",   "Coût minimal (Bellman-Ford)",             1, bench_min},
+    {"dinic", "Dinic",                                   0, bench_dinic},
+    {"prhl",  "Pousser-Réétiqueter (plus haute étiquette)", 0, bench_prhl},
+    {"dij",   "Coût minimal (Dijkstra)",                 1, bench_dij},
+    {"ns",    "Simplexe des réseaux",                    1, bench_ns},
+    {"ppr",   "Pousser-Réétiqueter parallèle",           0, bench_ppr},
+    {"cs",    "Ford-Fulkerson (mise à l'échelle)",       0, bench_cs},
+};
+#define BENCH_NUM_ALGORITHMS ((int)(sizeof(bench_algorithms) / sizeof(bench_algorithms[0])))
+
+// Compteurs matériels de chaque mesure (option -P), lus avec perf_event_open sur le thread de mesure.
+// Les threads créés pendant la résolution (Pousser-Réétiqueter parallèle) sont comptés à leur fin ; les
+// threads permanents des parcours en largeur (-b) ne le sont pas. Un compteur indisponible vaut -1.
+#define BENCH_PERF_EVENTS 4
+static const struct {
+    const char *name;
+    uint64_t config;
+} bench_perf_events[BENCH_PERF_EVENTS] = {
+    {"cycles",        PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions",  PERF_COUNT_HW_INSTRUCTIONS},
+    {"llc_misses",    PERF_COUNT_HW_CACHE_MISSES},  // Défauts du dernier niveau de cache sur la plupart des processeurs
+    {"branch_misses", PERF_COUNT_HW_BRANCH_MISSES},
+};
+static int bench_perf_warned = 0;
+
+// Ouvre les compteurs du thread appelant, arrêtés ; fds[k] = -1 si le compteur k est refusé
+static void bench_perf_open(int *fds) {
+    for (int k = 0; k < BENCH_PERF_EVENTS; k++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = bench_perf_events[k].config;
+        attr.disabled = 1;
+        attr.inherit = 1;                       // Threads créés pendant la mesure
+        attr.exclude_kernel = 1;                // Autorisé sans privilège (perf_event_paranoid <= 2)
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[k] < 0 && !__atomic_exchange_n(&bench_perf_warned, 1, __ATOMIC_RELAXED))
+            fprintf(stderr, "Compteur matériel %s indisponible (perf_event_open) : valeur -1.\n", bench_perf_events[k].name);
     }
-    return mat; // Retourne le pointeur vers la matrice allouée
 }
 
-// Fonction pour libérer la mémoire d'une matrice n x n
-void free_matrix(int **mat, int n) {
-    for (int i = 0; i < n; i++) { // Boucle sur chaque ligne de la matrice
-        free(mat[i]);            // Libère la mémoire de la ligne i
+static void bench_perf_start(const int *fds) {
+    for (int k = 0; k < BENCH_PERF_EVENTS; k++) {
+        if (fds[k] < 0) continue;
+        ioctl(fds[k], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[k], PERF_EVENT_IOC_ENABLE, 0);
     }
-    free(mat); // Libère le tableau de pointeurs
 }
 
-// Fonction pour afficher une matrice n x n avec un titre
-void print_matrix(int **mat, int n, const char *title) {
-    printf("%s\n", title);              // Affiche le titre
-    for (int i = 0; i < n; i++) {       // Parcourt chaque ligne
-        for (int j = 0; j < n; j++) {   // Parcourt chaque colonne
-            printf("%4d ", mat[i][j]);  // Affiche la valeur mat[i][j] avec un espacement
-        }
-        printf("\n");                  // Retour à la ligne après chaque ligne de la matrice
+// Arrête les compteurs et lit leurs valeurs, extrapolées si le noyau les a partagés dans le temps
+static void bench_perf_stop(const int *fds, long long *values) {
+    for (int k = 0; k < BENCH_PERF_EVENTS; k++)
+        if (fds[k] >= 0) ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+    for (int k = 0; k < BENCH_PERF_EVENTS; k++) {
+        uint64_t data[3];                       // Valeur, temps activé, temps compté
+        values[k] = -1;
+        if (fds[k] < 0 || read(fds[k], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0) continue;
+        values[k] = (long long)(data[2] < data[1] ? (double)data[0] * data[1] / data[2] : (double)data[0]);
     }
-    printf("\n");                       // Ligne vide après la matrice
 }
 
-// Fonction pour lire les données du fichier d'entrée dans la structure FlowNetwork
-int read_input_file(const char *filename, FlowNetwork *G) {
-    FILE *f = fopen(filename, "r");             // Ouvre le fichier en lecture
-    if (!f) {                                   // Si f est NULL, erreur d'ouverture
-        fprintf(stderr, "Impossible d'ouvrir le fichier %s. Vérifiez le nom et réessayez.\n", filename); // Message d'erreur plus clair
-        return 0;                               // Retourne 0 pour indiquer l'échec, ce qui permettra de redemander un nom de fichier
-    }
-
-    fscanf(f, "%d", &(G->n));        // Lit le nombre de sommets n
-    G->capacity = allocate_matrix(G->n); // Alloue la matrice de capacités de taille n x n
+static void bench_perf_close(int *fds) {
+    for (int k = 0; k < BENCH_PERF_EVENTS; k++)
+        if (fds[k] >= 0) close(fds[k]);
+}
 
-    for (int i = 0; i < G->n; i++) {     // Boucle sur chaque ligne de la matrice de capacités
-        for (int j = 0; j < G->n; j++) { // Boucle sur chaque colonne
-            fscanf(f, "%d", &(G->capacity[i][j])); // Lit la capacité c(i,j) depuis le fichier
-        }
-    }
+// Statistiques d'une série de mesures
+typedef struct {
+    double min, median, p95, p99, max;
+} BenchStats;
 
-    int c = fgetc(f);                              // Lit un caractère pour voir s'il y a plus de données
-    while (c == ' ' || c == '\n' || c == '\r' || c == '\t') c = fgetc(f); // Ignore les espaces et sauts de ligne
-    if (c != EOF) {                                // S'il y a encore des données dans le fichier
-        ungetc(c, f);                              // Replace le caractère lu
-        G->cost = allocate_matrix(G->n);            // Alloue la matrice de coûts n x n
-        for (int i = 0; i < G->n; i++) {            // Parcourt chaque ligne de la matrice de coûts
-            for (int j = 0; j < G->n; j++) {        // Parcourt chaque colonne
-                fscanf(f, "%d", &(G->cost[i][j]));  // Lit le coût d(i,j)
-            }
-        }
-        G->isMinCost = 1;                           // Indique qu'il s'agit d'un problème de flot à coût min
-    } else {
-        G->isMinCost = 0;                           // Pas de matrice de coûts
-        G->cost = NULL;                             // cost reste NULL
-    }
+static double bench_now(void) {   // Horloge monotone, en secondes
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
 
-    G->s = 0;                   // Définition de la source s=0
-    G->t = G->n - 1;            // Définition du puits t=n-1
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
 
-    fclose(f);                  // Ferme le fichier
-    return 1;                   // Retourne 1 pour indiquer le succès
+// Percentile au rang le plus proche sur des mesures triées
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)ceil(p / 100.0 * count);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
 }
 
-// Fonction auxiliaire : BFS utilisée par Edmond-Karp pour trouver un chemin augmentant
-int bfs_edmond_karp(int n, int **residual, int s, int t, int parent[]) {
-    int *visited = (int *)calloc(n, sizeof(int)); // Tableau visited initialisé à 0
-    for (int i = 0; i < n; i++)
-        parent[i] = -1;        // Initialise parent[] à -1
-
-    visited[s] = 1;            // Marque la source comme visitée
-    parent[s] = -1;            // La source n'a pas de parent
-
-    int *queue = (int *)malloc(n * sizeof(int));  // File pour la BFS
-    int front = 0, rear = 0;                      // Indices de la file
-    queue[rear++] = s;                            // Enfile la source
-
-    while (front < rear) {          // Tant que la file n'est pas vide
-        int u = queue[front++];     // Défile un sommet u
-        for (int v = 0; v < n; v++) {           // Parcourt tous les sommets v
-            if (!visited[v] && residual[u][v] > 0) { // Si non visité et capacité résiduelle > 0
-                queue[rear++] = v;                // Enfile v
-                parent[v] = u;                    // Met à jour le parent de v
-                visited[v] = 1;                   // Marque v comme visité
-                if (v == t) {                     // Si on a atteint le puits
-                    free(queue);                  // Libère la file
-                    free(visited);                // Libère visited
-                    return 1;                     // Chemin trouvé
-                }
-            }
-        }
-    }
-    free(queue);   // Libère la file si pas de chemin
-    free(visited); // Libère visited
-    return 0;       // Aucun chemin trouvé
+static BenchStats compute_stats(double *samples, int count) {
+    BenchStats st;
+    qsort(samples, count, sizeof(double), compare_double);
+    st.min = samples[0];
+    st.median = (count % 2) ? samples[count / 2] : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+    st.p95 = percentile(samples, count, 95.0);
+    st.p99 = percentile(samples, count, 99.0);
+    st.max = samples[count - 1];
+    return st;
 }
 
-// Algorithme Ford-Fulkerson (Edmond-Karp) pour trouver le flot max
-int ford_fulkerson(FlowNetwork *G) {
-    int n = G->n;                                   // Récupère le nombre de sommets
-    int **residual = allocate_matrix(n);            // Alloue le graphe résiduel
-    for (int i = 0; i < n; i++) {                   // Copie des capacités dans residual
-        for (int j = 0; j < n; j++) {
-            residual[i][j] = G->capacity[i][j];     // Initialisation du graphe résiduel = capacités
-        }
-    }
+static int compare_long_long(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
 
-    int *parent = (int *)malloc(n * sizeof(int));   // Tableau pour stocker le chemin BFS
-    int max_flow = 0;                               // Flot maximal initialisé à 0
+// Médiane d'un compteur en ignorant les valeurs non mesurées (-1) ; -1 si aucune ne l'est
+static long long counter_median(long long *values, int count) {
+    int valid = 0;
+    for (int r = 0; r < count; r++)
+        if (values[r] >= 0) values[valid++] = values[r];
+    if (valid == 0) return -1;
+    qsort(values, valid, sizeof(long long), compare_long_long);
+    return (valid % 2) ? values[valid / 2] : (values[valid / 2 - 1] + values[valid / 2]) / 2;
+}
 
-    // Tant qu'un chemin augmentant existe
-    while (bfs_edmond_karp(n, residual, G->s, G->t, parent)) {
-        int path_flow = INT_MAX;                    // Flot possible sur ce chemin
-        for (int v = G->t; v != G->s; v = parent[v]) { // Remonte le chemin trouvé
-            int u = parent[v];                      // u est le parent de v dans le chemin
-            if (residual[u][v] < path_flow)
-                path_flow = residual[u][v];         // Trouve le minimum résiduel sur le chemin
-        }
+// Écrit un compteur à la suite d'un enregistrement : colonne CSV (vide si non mesuré) ou champ JSON (null)
+static void write_counter(FILE *out, int json, const char *name, long long value) {
+    if (json) {
+        if (value >= 0) fprintf(out, ", \"%s\": %lld", name, value);
+        else fprintf(out, ", \"%s\": null", name);
+    } else {
+        if (value >= 0) fprintf(out, ",%lld", value);
+        else fprintf(out, ",");
+    }
+}
 
-        for (int v = G->t; v != G->s; v = parent[v]) { // Met à jour le graphe résiduel
-            int u = parent[v];
-            residual[u][v] -= path_flow;            // Réduit la capacité résiduelle dans le sens u->v
-            residual[v][u] += path_flow;            // Augmente la résiduelle dans l'autre sens v->u
-        }
+// Options du banc d'essai
+typedef struct {
+    int selected[BENCH_NUM_ALGORITHMS]; // Algorithmes retenus (option -a)
+    int repetitions;                    // Mesures par algorithme et par instance (option -r)
+    int warmup;                         // Exécutions non mesurées avant les mesures (option -w)
+    int json;                           // 1 : sortie JSON, 0 : CSV (option -f)
+    int workers;                        // Threads de mesure (option -j)
+    int pin;                            // 1 : chaque thread est fixé sur un cœur (option -p)
+    int perf;                           // 1 : compteurs matériels de chaque mesure (option -P)
+} BenchOptions;
+
+// Instance chargée une fois et partagée en lecture seule par tous les threads
+typedef struct {
+    const char *filename;
+    FlowNetwork G;
+    flow_sum_t desired_flow; // Flot désiré des algorithmes de coût
+} BenchInstance;
 
-        printf("Chemin augmentant trouvé avec flot = %d\n", path_flow); // Affiche le flot trouvé sur le chemin
-        max_flow += path_flow;                     // Ajoute path_flow au flot max total
-    }
+// Une tâche = une mesure (instance, algorithme, répétition)
+typedef struct {
+    int instance, algorithm, repetition;
+} BenchJob;
 
-    free(parent);           // Libère parent
-    free_matrix(residual, n); // Libère le graphe résiduel
-    return max_flow;        // Retourne le flot maximal
-}
+// Résultat d'une mesure, étiqueté par le thread et le cœur qui l'ont produite
+typedef struct {
+    double seconds;
+    long long value;        // Flot max, ou coût total pour un flot à coût minimal
+    int worker, cpu;
+    FlowStats stats;        // Compteurs du solveur pour cette mesure
+    long long perf[BENCH_PERF_EVENTS]; // Compteurs matériels (-1 : non mesurés)
+} BenchSample;
+
+// File de tâches d'un thread : il prend au début de [begin, end), les voleurs prennent à la fin
+typedef struct {
+    pthread_mutex_t lock;
+    int begin, end;
+} BenchQueue;
 
-// push_func : fonction pour pousser du flot de u vers v dans l'algorithme Push-Relabel
-static void push_func(int u, int v, int n, int **residual, int *excess) {
-    int send = (excess[u] < residual[u][v]) ? excess[u] : residual[u][v]; // On envoie le min(excess[u],residual[u][v])
-    residual[u][v] -= send;      // Réduit la résiduelle u->v
-    residual[v][u] += send;      // Augmente la résiduelle v->u
-    excess[u] -= send;           // Réduit l'excès de u
-    excess[v] += send;           // Augmente l'excès de v
-    // Au lieu de "Push de %d unités de %d vers %d", on affiche en français :
-    printf("Envoi de %d unités de flot du sommet %d vers le sommet %d\n", send, u+1, v+1); // Affiche l'action d'envoi
-}
+typedef struct {
+    const BenchOptions *opt;
+    BenchInstance *instances;
+    int num_instances;
+    BenchJob *jobs;         // Tâches de toutes les files, chaque file occupant une tranche
+    BenchQueue *queues;
+    BenchSample *samples;   // samples[(instance * BENCH_NUM_ALGORITHMS + algorithm) * repetitions + repetition]
+    int max_arcs;           // Plus grand m parmi les instances (taille des tampons de flot)
+} BenchPool;
 
-// relabel_func : fonction pour réétiqueter (augmenter la hauteur du sommet u)
-static void relabel_func(int u, int n, int **residual, int *height) {
-    int mh = INT_MAX;                      // mh = hauteur minimale parmi les voisins admissibles
-    for (int v = 0; v < n; v++) {          // Parcourt tous les voisins v
-        if (residual[u][v] > 0 && height[v] < mh) { // Si arête résiduelle u->v positive et height[v] plus petite
-            mh = height[v];                // Met à jour mh
+typedef struct {
+    BenchPool *pool;
+    int id;
+} BenchWorker;
+
+// Prend la prochaine tâche de sa propre file, ou en vole une à la fin de la file d'un autre thread.
+// Retourne 0 quand toutes les files sont vides (aucune tâche n'est créée pendant les mesures).
+static int bench_next_job(BenchPool *P, int self, BenchJob *job) {
+    int W = P->opt->workers;
+    for (int k = 0; k < W; k++) {
+        int w = (self + k) % W;
+        BenchQueue *Q = &P->queues[w];
+        int index = -1;
+        pthread_mutex_lock(&Q->lock);
+        if (Q->begin < Q->end) index = (k == 0) ? Q->begin++ : --Q->end;
+        pthread_mutex_unlock(&Q->lock);
+        if (index >= 0) {
+            *job = P->jobs[index];
+            return 1;
         }
     }
-    if (mh < INT_MAX) {
-        height[u] = mh + 1;                // Augmente la hauteur de u
-        // Au lieu de "Relabel du sommet ...", on affiche la version française :
-        printf("Réétiquetage du sommet %d, nouvelle hauteur = %d\n", u+1, height[u]); // Affiche l'action de réétiquetage
-    }
+    return 0;
 }
 
-// Algorithme pousser-réétiqueter (Push-Relabel) pour le flot max
-int push_relabel(FlowNetwork *G) {
-    int n = G->n;                                  // Nombre de sommets
-    int **capacity = G->capacity;                  // Raccourci vers la matrice des capacités
-
-    int **residual = allocate_matrix(n);           // Alloue le graphe résiduel
-    for (int i = 0; i < n; i++)
-        for (int j = 0; j < n; j++)
-            residual[i][j] = capacity[i][j];       // Copie des capacités dans residual
-
-    int *height = (int *)calloc(n, sizeof(int));   // Tableau des hauteurs, init à 0
-    int *excess = (int *)calloc(n, sizeof(int));   // Tableau des excès, init à 0
-    int *seen = (int *)calloc(n, sizeof(int));     // Tableau vu, pas forcément utilisé ici
-
-    height[G->s] = n;                              // Hauteur de la source = n
-    for (int v = 0; v < n; v++) {                  // Pousse immédiatement depuis la source
-        if (residual[G->s][v] > 0) {
-            excess[v] = residual[G->s][v];         // L'excès du voisin v = la capacité s->v
-            residual[v][G->s] = residual[G->s][v]; // Résiduel inverse
-            residual[G->s][v] = 0;                 // On a poussé tout le flot possible
-        }
+static void *bench_worker(void *arg) {
+    BenchWorker *self = (BenchWorker *)arg;
+    BenchPool *P = self->pool;
+    const BenchOptions *opt = P->opt;
+
+    if (opt->pin) {                             // Fixe le thread sur un cœur
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(self->id % (cpus > 0 ? cpus : 1), &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            fprintf(stderr, "Impossible de fixer le thread %d sur un cœur.\n", self->id);
     }
 
-    while (1) {
-        int done = 1;                      // Indicateur si aucune action n'est effectuée
-        for (int u = 0; u < n; u++) {      // Parcourt tous les sommets
-            if (u != G->s && u != G->t && excess[u] > 0) { // Si u a de l'excès (hors s,t)
-                done = 0;                                  // On va tenter quelque chose
-                for (int v = 0; v < n && excess[u] > 0; v++) { // Essaye de pousser vers les voisins
-                    if (residual[u][v] > 0 && height[u] == height[v] + 1) {
-                        push_func(u, v, n, residual, excess); // Pousse si admissible
-                    }
-                }
-                if (excess[u] > 0) {        // Si après tentative de push, excès > 0
-                    relabel_func(u, n, residual, height); // On relabel u
-                }
+    // État privé du thread : tampon de flot par arc, couples (instance, algorithme) déjà chauffés, et
+    // pour chaque instance une copie de l'en-tête du graphe (les tableaux restent partagés) et un contexte
+    // de résolution créé à la première mesure : les répétitions suivantes n'allouent plus rien
+    flow_cap_t *arc_flow = (flow_cap_t *)malloc((P->max_arcs > 0 ? P->max_arcs : 1) * sizeof(flow_cap_t));
+    char *warmed = (char *)calloc((size_t)P->num_instances * BENCH_NUM_ALGORITHMS, 1);
+    FlowNetwork *graphs = (FlowNetwork *)malloc((P->num_instances > 0 ? P->num_instances : 1) * sizeof(FlowNetwork));
+    FlowSolver *solvers = (FlowSolver *)malloc((P->num_instances > 0 ? P->num_instances : 1) * sizeof(FlowSolver));
+    char *ready = (char *)calloc(P->num_instances > 0 ? P->num_instances : 1, 1);
+    int perf_fds[BENCH_PERF_EVENTS];
+    for (int k = 0; k < BENCH_PERF_EVENTS; k++) perf_fds[k] = -1;
+    if (opt->perf) bench_perf_open(perf_fds);
+
+    BenchJob job;
+    while (bench_next_job(P, self->id, &job)) {
+        BenchInstance *I = &P->instances[job.instance];
+        const BenchAlgorithm *A = &bench_algorithms[job.algorithm];
+        FlowNetwork *G = &graphs[job.instance];
+        FlowSolver *solver = &solvers[job.instance];
+        if (!ready[job.instance]) {
+            *G = I->G;
+            if (!flow_solver_init(solver, G)) {
+                fprintf(stderr, "Mémoire insuffisante pour %s.\n", I->filename);
+                exit(1);
             }
+            ready[job.instance] = 1;
         }
-        if (done)                           // Si done = 1, aucune action, on s'arrête
-            break;
-    }
-
-    int max_flow = excess[G->t];            // Le flot max est l'excès au puits
-    free(height);                           // Libère height
-    free(excess);                           // Libère excess
-    free(seen);                             // Libère seen
-    free_matrix(residual, n);               // Libère le graphe résiduel
-    return max_flow;                        // Retourne le flot max
-}
+        G->arc_flow = A->needs_cost ? arc_flow : NULL;
 
-// Bellman-Ford pour trouver un plus court chemin en coût dans le graphe résiduel
-int bellman_ford(int n, int **capacity, int **cost, int **residual_cap, int **residual_cost, int s, int t, int *parent) {
-    int *dist = (int *)malloc(n * sizeof(int)); // Tableau des distances
-    for (int i = 0; i < n; i++) {
-        dist[i] = INT_MAX;          // Distance initiale = infinie
-        parent[i] = -1;             // Pas de parent au début
-    }
-    dist[s] = 0;                     // Distance à la source = 0
-
-    for (int k = 0; k < n-1; k++) {  // Relaxation n-1 fois
-        for (int u = 0; u < n; u++) {
-            for (int v = 0; v < n; v++) {
-                if (residual_cap[u][v] > 0 && dist[u] != INT_MAX && dist[u] + residual_cost[u][v] < dist[v]) {
-                    dist[v] = dist[u] + residual_cost[u][v]; // Mise à jour de la distance
-                    parent[v] = u;                            // Mise à jour du parent
-                }
-            }
+        int key = job.instance * BENCH_NUM_ALGORITHMS + job.algorithm;
+        if (!warmed[key]) {                     // Échauffement la première fois que ce thread voit ce couple
+            for (int w = 0; w < opt->warmup; w++)
+                A->run(solver, I->desired_flow);
+            warmed[key] = 1;
         }
-    }
 
-    printf("Table de Bellman-Ford (dist):\n"); // Affiche les distances trouvées
-    for (int i = 0; i < n; i++) {
-        if (dist[i] == INT_MAX) printf("  INF");  // Affiche INF si inaccessible
-        else printf("%5d", dist[i]);              // Sinon affiche la distance
+        long long perf[BENCH_PERF_EVENTS];
+        if (opt->perf) bench_perf_start(perf_fds);  // Hors de l'intervalle chronométré
+        double start = bench_now();
+        flow_sum_t value = A->run(solver, I->desired_flow);
+        double seconds = bench_now() - start;
+        if (opt->perf) bench_perf_stop(perf_fds, perf);
+        else for (int k = 0; k < BENCH_PERF_EVENTS; k++) perf[k] = -1;
+
+        BenchSample *S = &P->samples[(size_t)key * opt->repetitions + job.repetition];
+        S->seconds = seconds;
+        S->value = value;
+        S->stats = solver->stats;
+        memcpy(S->perf, perf, sizeof(perf));
+        if (A->needs_cost) S->value = flow_cost_of(G, arc_flow);   // Coût recalculé hors mesure
+        S->worker = self->id;
+        S->cpu = sched_getcpu();
     }
-    printf("\n");
 
-    int reachable = (dist[t] != INT_MAX); // 1 si t est accessible, 0 sinon
-    free(dist);                           // Libère dist
-    return reachable;                     // Retourne reachable
+    for (int i = 0; i < P->num_instances; i++)
+        if (ready[i]) flow_solver_free(&solvers[i]);
+    bench_perf_close(perf_fds);
+    free(ready);
+    free(solvers);
+    free(graphs);
+    free(arc_flow);
+    free(warmed);
+    return NULL;
 }
 
-// Flot à coût minimal pour un flot donné desired_flow
-int min_cost_flow(FlowNetwork *G, int desired_flow) {
-    int n = G->n;                                         // Nombre de sommets
-    int **residual_cap = allocate_matrix(n);              // Graphe résiduel pour les capacités
-    int **residual_cost = allocate_matrix(n);             // Graphe résiduel pour les coûts
-
-    for (int i = 0; i < n; i++) {                         // Initialisation du graphe résiduel
-        for (int j = 0; j < n; j++) {
-            residual_cap[i][j] = G->capacity[i][j];       // Copie des capacités
-            residual_cost[i][j] = G->cost[i][j];          // Copie des coûts
+// Répartit les tâches entre les files puis lance les threads. Les tâches sont triées de la plus
+// grosse instance à la plus petite et distribuées à tour de rôle : chaque thread commence par les
+// mesures les plus longues et le vol de tâches équilibre la fin.
+static void bench_run_pool(BenchPool *P) {
+    const BenchOptions *opt = P->opt;
+    int W = opt->workers;
+    int num_jobs = 0;
+    for (int i = 0; i < P->num_instances; i++)
+        for (int k = 0; k < BENCH_NUM_ALGORITHMS; k++)
+            if (opt->selected[k] && (!bench_algorithms[k].needs_cost || P->instances[i].G.isMinCost))
+                num_jobs += opt->repetitions;
+
+    int *by_size = (int *)malloc((P->num_instances > 0 ? P->num_instances : 1) * sizeof(int));
+    for (int i = 0; i < P->num_instances; i++) by_size[i] = i;
+    for (int i = 1; i < P->num_instances; i++) {  // Tri par insertion, m décroissant
+        int x = by_size[i], j = i;
+        while (j > 0 && P->instances[by_size[j - 1]].G.m < P->instances[x].G.m) {
+            by_size[j] = by_size[j - 1];
+            j--;
         }
+        by_size[j] = x;
     }
 
-    int *parent = (int *)malloc(n * sizeof(int));          // Tableau parent pour Bellman-Ford
-    int flow = 0;                                          // Flot actuel = 0
-    int cost_total = 0;                                    // Coût total = 0
-
-    while (flow < desired_flow) {                          // Tant qu'on n'a pas atteint le flot désiré
-        if (!bellman_ford(n, G->capacity, G->cost, residual_cap, residual_cost, G->s, G->t, parent))
-            break; // Pas de chemin augmentant de coût minimal si Bellman-Ford échoue
-
-        int path_flow = desired_flow - flow;               // On peut envoyer au plus (desired_flow - flow)
-        for (int v = G->t; v != G->s; v = parent[v]) {     // Trouve le max de flot possible sur ce chemin
-            int u = parent[v];
-            if (residual_cap[u][v] < path_flow)
-                path_flow = residual_cap[u][v];            // min sur le chemin
-        }
-
-        for (int v = G->t; v != G->s; v = parent[v]) {     // Met à jour le graphe résiduel
-            int u = parent[v];
-            residual_cap[u][v] -= path_flow;               // Réduit la capacité résiduelle u->v
-            residual_cap[v][u] += path_flow;               // Augmente la résiduelle v->u
-            cost_total += path_flow * residual_cost[u][v]; // Ajoute le coût
+    P->jobs = (BenchJob *)malloc((num_jobs > 0 ? num_jobs : 1) * sizeof(BenchJob));
+    P->queues = (BenchQueue *)malloc(W * sizeof(BenchQueue));
+    int *fill = (int *)malloc(W * sizeof(int));
+    for (int w = 0; w < W; w++) {               // La file w reçoit les tâches d'indice k ≡ w (mod W)
+        P->queues[w].begin = w * (num_jobs / W) + (w < num_jobs % W ? w : num_jobs % W);
+        P->queues[w].end = P->queues[w].begin + num_jobs / W + (w < num_jobs % W);
+        fill[w] = P->queues[w].begin;
+        pthread_mutex_init(&P->queues[w].lock, NULL);
+    }
+    int k = 0;
+    for (int r = 0; r < opt->repetitions; r++) {  // Répétitions entrelacées : une instance n'occupe pas un seul thread
+        for (int x = 0; x < P->num_instances; x++) {
+            int i = by_size[x];
+            for (int a = 0; a < BENCH_NUM_ALGORITHMS; a++) {
+                if (!opt->selected[a] || (bench_algorithms[a].needs_cost && !P->instances[i].G.isMinCost)) continue;
+                BenchJob job = {i, a, r};
+                P->jobs[fill[k % W]++] = job;
+                k++;
+            }
         }
+    }
 
-        printf("Chaîne augmentante trouvée, flot = %d\n", path_flow); // Affiche le flot sur ce chemin
-        flow += path_flow;                                  // Met à jour le flot total
+    pthread_t *threads = (pthread_t *)malloc(W * sizeof(pthread_t));
+    BenchWorker *workers = (BenchWorker *)malloc(W * sizeof(BenchWorker));
+    int *started = (int *)calloc(W, sizeof(int));
+    for (int w = 0; w < W; w++) {
+        workers[w].pool = P;
+        workers[w].id = w;
+        if (w > 0) started[w] = pthread_create(&threads[w], NULL, bench_worker, &workers[w]) == 0;
     }
+    bench_worker(&workers[0]);                  // Le thread principal est le thread 0
+    for (int w = 1; w < W; w++)
+        if (started[w]) pthread_join(threads[w], NULL); // Un thread non créé laisse sa file aux voleurs
+
+    for (int w = 0; w < W; w++) pthread_mutex_destroy(&P->queues[w].lock);
+    free(started);
+    free(workers);
+    free(threads);
+    free(fill);
+    free(by_size);
+    free(P->queues);
+    free(P->jobs);
+}
 
-    if (flow < desired_flow) {                              // Si on n'a pas atteint le flot désiré
-        printf("Impossible d'atteindre le flot désiré.\n");
+// Écrit le résumé d'un couple (instance, algorithme) dans out et à l'écran
+static void bench_report(const BenchInstance *I, const BenchAlgorithm *A, const BenchSample *samples,
+                         const BenchOptions *opt, FILE *out, int *first_record) {
+    int repetitions = opt->repetitions, json = opt->json;
+    double *seconds = (double *)malloc(repetitions * sizeof(double));
+    for (int r = 0; r < repetitions; r++) seconds[r] = samples[r].seconds;
+    BenchStats st = compute_stats(seconds, repetitions);
+    free(seconds);
+
+    int arcs = I->G.m / 2;                      // Arcs du graphe (sans les arcs inverses)
+    long long result = samples[0].value;
+    double throughput = st.median > 0 ? arcs / st.median : 0.0;
+    printf("%-28s n=%-6d %-6s médiane %.6f s  p95 %.6f s  p99 %.6f s  (%.3g arcs/s)\n",
+           I->filename, I->G.n, A->name, st.median, st.p95, st.p99, throughput);
+    if (json) {
+        fprintf(out, "%s\n  {\"instance\": \"%s\", \"n\": %d, \"arcs\": %d, \"algorithm\": \"%s\", \"repetitions\": %d, "
+                     "\"value\": %lld, \"min_s\": %.9f, \"median_s\": %.9f, \"p95_s\": %.9f, \"p99_s\": %.9f, "
+                     "\"max_s\": %.9f, \"arcs_per_s\": %.1f",
+                *first_record ? "" : ",", I->filename, I->G.n, arcs, A->name, repetitions,
+                result, st.min, st.median, st.p95, st.p99, st.max, throughput);
     } else {
-        printf("Flot atteint = %d, Coût total = %d\n", flow, cost_total); // Affiche le flot et le coût total
+        fprintf(out, "%s,%d,%d,%s,%d,%lld,%.9f,%.9f,%.9f,%.9f,%.9f,%.1f",
+                I->filename, I->G.n, arcs, A->name, repetitions,
+                result, st.min, st.median, st.p95, st.p99, st.max, throughput);
     }
 
-    free(parent);                       // Libère parent
-    free_matrix(residual_cap, n);       // Libère residual_cap
-    free_matrix(residual_cost, n);      // Libère residual_cost
-    return 0;                           // Retourne 0
-}
-void free_flow_network(FlowNetwork *G) {
-    free_matrix(G->capacity, G->n);
-    if (G->cost) {
-        free_matrix(G->cost, G->n);
+    // Médiane de chaque compteur sur les répétitions, à côté des temps
+    long long *values = (long long *)malloc(repetitions * sizeof(long long));
+    for (int c = 0; c < FLOW_STAT_COUNT; c++) {
+        for (int r = 0; r < repetitions; r++) values[r] = samples[r].stats.count[c];
+        write_counter(out, json, flow_stat_names[c], counter_median(values, repetitions));
+    }
+    for (int k = 0; opt->perf && k < BENCH_PERF_EVENTS; k++) {
+        for (int r = 0; r < repetitions; r++) values[r] = samples[r].perf[k];
+        write_counter(out, json, bench_perf_events[k].name, counter_median(values, repetitions));
     }
+    free(values);
+    fprintf(out, json ? "}" : "\n");
+    *first_record = 0;
 }
-void run_complexity_tests(const char *filename, FILE *results, FILE *max_times, int n, int num_tests) {
-    double max_ff = 0.0, max_pr = 0.0, max_min = 0.0;
 
-    for (int test = 0; test < num_tests; test++) {
-        FlowNetwork G;
-        if (!read_input_file(filename, &G)) {
-            fprintf(stderr, "Erreur lors de la lecture du fichier %s\n", filename);
+// Charge les instances, exécute toutes les mesures sur le groupe de threads puis écrit les résultats.
+// Retourne le nombre de résumés écrits.
+static int run_benchmark(char **filenames, int num_files, const BenchOptions *opt, FILE *out, FILE *samples_out) {
+    BenchPool P;
+    P.opt = opt;
+    P.instances = (BenchInstance *)malloc((num_files > 0 ? num_files : 1) * sizeof(BenchInstance));
+    P.num_instances = 0;
+    P.max_arcs = 0;
+    for (int f = 0; f < num_files; f++) {
+        BenchInstance *I = &P.instances[P.num_instances];
+        if (!read_input_file(filenames[f], &I->G)) {
+            fprintf(stderr, "Erreur lors de la lecture du fichier %s\n", filenames[f]);
             continue;
         }
-
-        // 1. Temps pour Ford-Fulkerson
-        clock_t start = clock();
-        ford_fulkerson(&G);
-        clock_t end = clock();
-        double time_ff = (double)(end - start) / CLOCKS_PER_SEC;
-        if (time_ff > max_ff) max_ff = time_ff;
-
-        // 2. Temps pour Pousser-Réétiqueter
-        start = clock();
-        push_relabel(&G);
-        end = clock();
-        double time_pr = (double)(end - start) / CLOCKS_PER_SEC;
-        if (time_pr > max_pr) max_pr = time_pr;
-
-        // 3. Temps pour Flot à coût minimal
-        int max_flow = push_relabel(&G);  // Utiliser Push-Relabel pour flot max
-        int desired_flow = max_flow / 2; // Prendre la moitié pour flot min-cost
-        start = clock();
-        min_cost_flow(&G, desired_flow);
-        end = clock();
-        double time_min = (double)(end - start) / CLOCKS_PER_SEC;
-        if (time_min > max_min) max_min = time_min;
-
-        // Sauvegarder les résultats pour ce test
-        fprintf(results, "%d %d %.6f %.6f %.6f\n", n, test, time_ff, time_pr, time_min);
-
-        free_flow_network(&G);
+        I->filename = filenames[f];
+        FlowSolver solver;
+        if (!flow_solver_init(&solver, &I->G)) {
+            fprintf(stderr, "Mémoire insuffisante pour %s\n", filenames[f]);
+            free_flow_network(&I->G);
+            continue;
+        }
+        I->desired_flow = dinic(&solver) / 2;  // La moitié du flot max, calculée une fois
+        flow_solver_free(&solver);
+        if (I->G.demand > 0) I->desired_flow = I->G.demand; // Sauf s'il est imposé par le fichier
+        if (I->G.m > P.max_arcs) P.max_arcs = I->G.m;
+        P.num_instances++;
     }
+    size_t num_slots = (size_t)P.num_instances * BENCH_NUM_ALGORITHMS * opt->repetitions;
+    P.samples = (BenchSample *)calloc(num_slots > 0 ? num_slots : 1, sizeof(BenchSample));
+
+    double start = bench_now();
+    bench_run_pool(&P);
+    double wall = bench_now() - start;
+
+    int written = 0, first_record = 1;
+    for (int i = 0; i < P.num_instances; i++) {
+        const BenchInstance *I = &P.instances[i];
+        long long reference_cost = -1;
+        for (int k = 0; k < BENCH_NUM_ALGORITHMS; k++) {
+            const BenchAlgorithm *A = &bench_algorithms[k];
+            if (!opt->selected[k] || (A->needs_cost && !I->G.isMinCost)) continue;
+            const BenchSample *S = &P.samples[((size_t)i * BENCH_NUM_ALGORITHMS + k) * opt->repetitions];
+            for (int r = 0; r < opt->repetitions; r++) {
+                if (S[r].value != S[0].value)
+                    fprintf(stderr, "Résultat instable pour %s : %s donne %lld puis %lld\n", I->filename, A->name, S[0].value, S[r].value);
+                if (!samples_out) continue;
+                fprintf(samples_out, "%s,%s,%d,%d,%d,%.9f,%lld", I->filename, A->name, r, S[r].worker, S[r].cpu, S[r].seconds, S[r].value);
+                for (int c = 0; c < FLOW_STAT_COUNT; c++) write_counter(samples_out, 0, NULL, S[r].stats.count[c]);
+                for (int k = 0; opt->perf && k < BENCH_PERF_EVENTS; k++) write_counter(samples_out, 0, NULL, S[r].perf[k]);
+                fprintf(samples_out, "\n");
+            }
+            if (A->needs_cost) {
+                if (reference_cost >= 0 && S[0].value != reference_cost)
+                    fprintf(stderr, "Écart de coût pour %s : %s donne %lld au lieu de %lld\n", I->filename, A->name, S[0].value, reference_cost);
+                if (reference_cost < 0) reference_cost = S[0].value;
+            }
+            bench_report(I, A, S, opt, out, &first_record);
+            written++;
+        }
+    }
+    printf("Durée totale des mesures : %.3f s avec %d thread(s)\n", wall, opt->workers);
 
-    // Sauvegarder les temps maximum pour cette taille
-    fprintf(max_times, "%d %.6f %.6f %.6f\n", n, max_ff, max_pr, max_min);
+    for (int i = 0; i < P.num_instances; i++) free_flow_network(&P.instances[i].G);
+    free(P.instances);
+    free(P.samples);
+    return written;
 }
 
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage : %s [-a algos] [-n tailles] [-d dossier] [-r répétitions] [-w échauffement] [-j threads] [-p] [-t threads] [-b threads] [-x 0|1|2] [-R] [-P]\n"
+            "          [-f csv|json] [-o fichier] [-s mesures.csv] [instances...]\n"
+            "  -a  algorithmes séparés par des virgules parmi ff,pr,min,dinic,prhl,dij,ns,ppr,cs (défaut : tous)\n"
+            "  -n  tailles séparées par des virgules : dossier/flow_problem_nX.bin ou .txt (défaut : 10,20,40,100,400)\n"
+            "  -d  dossier des instances flow_problem_nX (défaut : ../Benchmark)\n"
+            "  -r  mesures par algorithme et par instance (défaut : 100)\n"
+            "  -w  exécutions d'échauffement non mesurées, par thread (défaut : 2)\n"
+            "  -j  threads de mesure, 0 = un par cœur (défaut : 1)\n"
+            "  -p  fixe chaque thread sur un cœur\n"
+            "  -t  threads de Pousser-Réétiqueter parallèle (ppr), 0 = un par cœur (défaut : 0)\n"
+            "  -b  threads des parcours en largeur (ff, cs, prhl), 0 = un par cœur (défaut : 1)\n"
+            "  -x  jeu d'instructions maximal des noyaux : 0 scalaire, 1 AVX2, 2 AVX-512 (défaut : le meilleur disponible)\n"
+            "  -R  résout les graphes tels quels, sans la réduction préalable (sommets inutiles, chaînes, arcs parallèles)\n"
+            "  -P  compteurs matériels de chaque mesure (cycles, instructions, défauts de cache LLC, erreurs de prédiction\n"
+            "      de branchement) via perf_event_open, à la suite des compteurs du solveur\n"
+            "  -f  format du fichier de résultats (défaut : csv)\n"
+            "  -o  fichier de résultats (défaut : ../Benchmark/results.csv ou .json)\n"
+            "  -s  fichier CSV de chaque mesure, avec le thread et le cœur qui l'ont produite\n"
+            "Les instances données en argument remplacent la liste des tailles.\n", prog);
+}
 
-int main() {
-    // Tailles des problèmes de flot à tester
-    int sizes[] = {400};
-    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
-
-    // Fichiers pour stocker les résultats
-    FILE *results = fopen("Benchmark/results.txt", "w");
-    FILE *max_times = fopen("Benchmark/max_values.txt", "w");
+// Sélectionne les algorithmes d'une liste "ff,dinic,..." ; retourne 0 si un nom est inconnu
+static int parse_algorithms(char *list, int *selected) {
+    memset(selected, 0, BENCH_NUM_ALGORITHMS * sizeof(int));
+    for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+        int found = 0;
+        for (int k = 0; k < BENCH_NUM_ALGORITHMS; k++) {
+            if (strcmp(name, bench_algorithms[k].name) == 0) {
+                selected[k] = 1;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Algorithme inconnu : %s\n", name);
+            return 0;
+        }
+    }
+    return 1;
+}
 
-    if (!results || !max_times) {
-        fprintf(stderr, "Erreur lors de l'ouverture des fichiers de résultats.\n");
+// Fonction main : lit les options, puis mesure les instances
+int main(int argc, char **argv) {
+    trace_set_level(TRACE_NONE);  // Aucune trace pendant les mesures : les solveurs n'écrivent rien
+
+    BenchOptions opt;
+    for (int k = 0; k < BENCH_NUM_ALGORITHMS; k++) opt.selected[k] = 1;
+    opt.repetitions = 100;
+    opt.warmup = 2;
+    opt.json = 0;
+    opt.workers = 1;
+    opt.pin = 0;
+    opt.perf = 0;
+    char default_sizes[] = "10,20,40,100,400";
+    char *sizes = default_sizes;
+    const char *dir = "../Benchmark";
+    const char *output = NULL;
+    const char *samples_file = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "a:n:d:r:w:j:pt:b:x:RPf:o:s:h")) != -1) {
+        switch (c) {
+        case 'a':
+            if (!parse_algorithms(optarg, opt.selected)) return 1;
+            break;
+        case 'n': sizes = optarg; break;
+        case 'd': dir = optarg; break;
+        case 'r': opt.repetitions = atoi(optarg); break;
+        case 'w': opt.warmup = atoi(optarg); break;
+        case 'j': opt.workers = atoi(optarg); break;
+        case 'p': opt.pin = 1; break;
+        case 't': bench_solver_threads = atoi(optarg); break;
+        case 'b': bfs_set_threads(atoi(optarg)); break;
+        case 'x': simd_set_level(atoi(optarg)); break;
+        case 'R': reduction_set_enabled(0); break;
+        case 'P': opt.perf = 1; break;
+        case 'f':
+            if (strcmp(optarg, "json") == 0) opt.json = 1;
+            else if (strcmp(optarg, "csv") == 0) opt.json = 0;
+            else { usage(argv[0]); return 1; }
+            break;
+        case 'o': output = optarg; break;
+        case 's': samples_file = optarg; break;
+        default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (opt.workers == 0) {                       // Un thread par cœur disponible
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        opt.workers = cpus > 0 ? (int)cpus : 1;
+    }
+    if (opt.repetitions < 1 || opt.warmup < 0 || opt.workers < 1) {
+        usage(argv[0]);
         return 1;
     }
 
-    fprintf(results, "# Format: n test_number time_FF time_PR time_MIN\n");
-    fprintf(max_times, "# Format: n max_time_FF max_time_PR max_time_MIN\n");
-
-    // Boucle sur les différentes tailles n
-    for (int i = 0; i < num_sizes; i++) {
-        int n = sizes[i];
-        char filename[50];
-        sprintf(filename, "flow_problem_n%d.txt", n);
-
-        printf("Tests pour n = %d...\n", n);
-        run_complexity_tests(filename, results, max_times, n, 100);
+    // Liste des instances : arguments, ou fichiers flow_problem_nX du dossier
+    char **filenames;
+    int num_files = 0;
+    if (optind < argc) {
+        filenames = argv + optind;
+        num_files = argc - optind;
+    } else {
+        filenames = (char **)malloc((strlen(sizes) / 2 + 1) * sizeof(char *)); // Au plus une taille par deux caractères
+        for (char *size = strtok(sizes, ","); size; size = strtok(NULL, ",")) {
+            char *filename = (char *)malloc(strlen(dir) + strlen(size) + 32);
+            sprintf(filename, "%s/flow_problem_n%s.bin", dir, size); // Version binaire si le convertisseur l'a produite
+            FILE *probe = fopen(filename, "rb");
+            if (probe) {
+                fclose(probe);
+            } else {
+                sprintf(filename, "%s/flow_problem_n%s.txt", dir, size);
+            }
+            filenames[num_files++] = filename;
+        }
     }
 
-    fclose(results);
-    fclose(max_times);
+    char default_output[64];
+    if (!output) {
+        snprintf(default_output, sizeof(default_output), "../Benchmark/results.%s", opt.json ? "json" : "csv");
+        output = default_output;
+    }
+    FILE *out = fopen(output, "w");
+    FILE *samples_out = samples_file ? fopen(samples_file, "w") : NULL;
+    if (!out || (samples_file && !samples_out)) {
+        fprintf(stderr, "Erreur lors de l'ouverture des fichiers de résultats.\n");
+        return 1;
+    }
+    if (opt.json) fprintf(out, "[");
+    else fprintf(out, "instance,n,arcs,algorithm,repetitions,value,min_s,median_s,p95_s,p99_s,max_s,arcs_per_s");
+    if (samples_out) fprintf(samples_out, "instance,algorithm,repetition,worker,cpu,seconds,value");
+    for (int c = 0; c < FLOW_STAT_COUNT; c++) {     // Colonnes des compteurs, à la suite des temps
+        if (!opt.json) fprintf(out, ",%s", flow_stat_names[c]);
+        if (samples_out) fprintf(samples_out, ",%s", flow_stat_names[c]);
+    }
+    for (int k = 0; opt.perf && k < BENCH_PERF_EVENTS; k++) {
+        if (!opt.json) fprintf(out, ",%s", bench_perf_events[k].name);
+        if (samples_out) fprintf(samples_out, ",%s", bench_perf_events[k].name);
+    }
+    if (!opt.json) fprintf(out, "\n");
+    if (samples_out) fprintf(samples_out, "\n");
+
+    printf("Mesures de %d instance(s) sur %d thread(s)...\n", num_files, opt.workers);
+    int total = run_benchmark(filenames, num_files, &opt, out, samples_out);
+
+    if (opt.json) fprintf(out, "\n]\n");
+    fclose(out);
+    if (samples_out) fclose(samples_out);
+    if (optind >= argc) {
+        for (int f = 0; f < num_files; f++) free(filenames[f]);
+        free(filenames);
+    }
 
-    printf("Tests terminés. Résultats enregistrés dans 'results.txt' et 'max_values.txt'.\n");
+    printf("Tests terminés. %d résultats enregistrés dans '%s'.\n", total, output);
     return 0;
-}
\ No newline at end of file
+}
@@ -1,138 +1,733 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>     // INT_MAX
+#include <stdint.h>     // Générateurs pseudo-aléatoires 64 bits
 #include <time.h>
 #include <math.h>
+#include <unistd.h>     // getopt, sysconf
+#include <sys/stat.h>   // mkdir
+#include <pthread.h>    // Génération des lignes en parallèle
+#include "flow.h"       // Graphes CSR et format binaire (bibliothèque commune)
+
+// Générateur de graphes aléatoires : chaque couple (u, v), u != v, porte un arc avec la probabilité
+// « densité », de capacité et de coût tirés uniformément dans 1..GEN_MAX_VALUE. Chaque ligne u a son
+// propre flux pseudo-aléatoire (xoshiro256**, initialisé par splitmix64 à partir de la graine et de u) :
+// une ligne se régénère à l'identique, dans n'importe quel ordre et sur n'importe quel thread. Le fichier
+// ne dépend donc que de la graine, de la taille et de la densité, pas du nombre de threads. Les lignes
+// sont produites par paquets en parallèle puis écrites dans l'ordre, sans matrice n x n en mémoire.
+#define GEN_MAX_THREADS 64
+#define GEN_BATCH_ROWS 64           // Lignes au plus par thread et par paquet
+#define GEN_BATCH_BYTES (1 << 22)   // Taille visée du texte d'un thread pour un paquet
+#define GEN_MAX_VALUE 100           // Capacités et coûts dans 1..GEN_MAX_VALUE
+#define GEN_DENSE 0.1               // Au-dessus, un tirage par case ; en dessous, sauts géométriques
 
-//----------------------------------------------------------
-// Structure pour représenter un problème de flot
-//----------------------------------------------------------
 typedef struct {
-    int n;              // Nombre de sommets
-    int **capacity;     // Matrice des capacités (C)
-    int **cost;         // Matrice des coûts (D)
-} FlowProblem;
-
-//----------------------------------------------------------
-// Fonction pour allouer une matrice n x n initialisée à 0
-//----------------------------------------------------------
-int **allocate_matrix(int n) {
-    int **mat = (int **)malloc(n * sizeof(int *));
-    for (int i = 0; i < n; i++) {
-        mat[i] = (int *)calloc(n, sizeof(int));  // Initialisation à 0
-    }
-    return mat;
-}
-
-//----------------------------------------------------------
-// Fonction pour libérer une matrice n x n
-//----------------------------------------------------------
-void free_matrix(int **mat, int n) {
-    for (int i = 0; i < n; i++) {
-        free(mat[i]);
-    }
-    free(mat);
-}
-
-//----------------------------------------------------------
-// Génération aléatoire des matrices de capacité et de coût
-//----------------------------------------------------------
-void generate_random_flow_problem(FlowProblem *problem) {
-    int n = problem->n;
-    int edges = (n * n) / 2;  // Environ la moitié des arêtes possibles
-
-    // Initialiser les matrices à 0
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            problem->capacity[i][j] = 0;
-            if (problem->cost) {
-                problem->cost[i][j] = 0;
-            }
-        }
+    uint64_t s[4];
+} GenRng;
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void gen_rng_seed(GenRng *r, uint64_t seed, int row) {   // Flux de la ligne row
+    uint64_t x = seed ^ (0xD1B54A32D192ED03ULL * (uint64_t)(row + 1));
+    for (int k = 0; k < 4; k++) r->s[k] = splitmix64(&x);
+}
+
+static inline uint64_t gen_rng_next(GenRng *r) {                // xoshiro256**
+    uint64_t *s = r->s;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+static inline double gen_rng_uniform(GenRng *r) {               // Réel uniforme dans [0, 1)
+    return (gen_rng_next(r) >> 11) * 0x1.0p-53;
+}
+
+static inline int gen_rng_value(GenRng *r) {                    // Entier uniforme dans 1..GEN_MAX_VALUE
+    return 1 + (int)(((gen_rng_next(r) >> 32) * GEN_MAX_VALUE) >> 32);
+}
+
+typedef enum { GEN_TEXT, GEN_DIMACS, GEN_BINARY, GEN_GRID_CELLS } GenFormat;  // GEN_GRID_CELLS : fichier grille (famille grid)
+
+// Familles d'instances. Toutes gardent la convention des fichiers texte : s = 0 et t = n-1.
+//  random    : chaque couple (u, v) porte un arc avec la probabilité -d
+//  layered   : réseau en couches de type GENRMF (Goldberg) : b cadres de a x a sommets, une grille de forte
+//              capacité dans chaque cadre, et une permutation aléatoire de faible capacité d'un cadre au suivant
+//  paths     : k chemins disjoints de longueurs 1..k entre s et t, reliés en escalier : les chemins augmentants
+//              s'allongent d'un arc à chaque fois, ce qui multiplie les BFS d'Edmonds-Karp et les phases de Dinic
+//  grid      : grille de type réseau routier (arcs dans les deux sens entre voisins), s relié à la première
+//              colonne, la dernière colonne reliée à t
+//  transport : biparti offreurs -> demandeurs comme les cas à coûts de Data/RO*.txt (arcs avec la probabilité -d)
+//  rmat      : graphe en loi de puissance R-MAT (a, b, c, d) = (0.57, 0.19, 0.19, 0.05), 16 arcs par sommet en moyenne
+typedef enum { GEN_RANDOM, GEN_LAYERED, GEN_PATHS, GEN_GRID, GEN_TRANSPORT, GEN_RMAT, GEN_NUM_FAMILIES } GenFamily;
+
+static const char *gen_family_names[GEN_NUM_FAMILIES] = { "random", "layered", "paths", "grid", "transport", "rmat" };
+
+#define GEN_RMAT_A 0.57
+#define GEN_RMAT_B 0.19
+#define GEN_RMAT_C 0.19
+#define GEN_RMAT_EDGE_FACTOR 16
+
+typedef struct {
+    int n;
+    GenFamily family;
+    double density;     // random, transport : probabilité qu'un couple (u, v) porte un arc
+    uint64_t seed;
+    int with_cost;      // Écrit aussi les coûts (format texte et binaire)
+    int a, b;           // layered : côté et nombre de cadres ; paths : k ; grid : colonnes et lignes ;
+                        // transport : offreurs et demandeurs ; rmat : 2^a sommets internes
+    double avg_degree;  // Arcs par sommet attendus (taille des paquets de texte)
+} GenParams;
+
+// Dimensionne la famille pour environ size sommets ; P->n reçoit le nombre exact. Retourne 0 si size est trop petit.
+static int gen_layout(GenParams *P, int size) {
+    switch (P->family) {
+    case GEN_RANDOM:
+        P->n = size;
+        P->avg_degree = P->density * (size - 1);
+        return size >= 2;
+    case GEN_LAYERED:
+        P->a = (int)round(cbrt((double)size));
+        if (P->a < 2) P->a = 2;
+        P->b = size / (P->a * P->a);
+        if (P->b < 2) P->b = 2;
+        P->n = P->a * P->a * P->b;
+        P->avg_degree = 5;
+        return size >= 8;
+    case GEN_PATHS:
+        for (P->a = 1; 2 + (P->a + 1) * (P->a + 2) / 2 <= size; P->a++) {}
+        P->n = 2 + P->a * (P->a + 1) / 2;
+        P->avg_degree = 2;
+        return size >= 3;
+    case GEN_GRID:
+        P->a = (int)round(sqrt((double)(size - 2)));
+        if (P->a < 2) P->a = 2;
+        P->b = (size - 2) / P->a;
+        if (P->b < 1) P->b = 1;
+        P->n = 2 + P->a * P->b;
+        P->avg_degree = 4;
+        return size >= 4;
+    case GEN_TRANSPORT:
+        P->a = (size - 2) / 2;
+        P->b = size - 2 - P->a;
+        P->n = size;
+        P->avg_degree = P->density * P->b / 2 + 1;
+        return size >= 4;
+    case GEN_RMAT:
+        for (P->a = 1; (1 << P->a) < size; P->a++) {}
+        P->n = size;
+        P->avg_degree = GEN_RMAT_EDGE_FACTOR;
+        return size >= 2 && P->a < 31;
+    default:
+        return 0;
     }
+}
 
-    // Remplir les matrices avec des valeurs aléatoires
-    int count = 0;
-    while (count < edges) {
-        int i = rand() % n;
-        int j = rand() % n;
+static void gen_sort_heads(int *heads, int k) {     // Tri par insertion (lignes courtes)
+    for (int i = 1; i < k; i++) {
+        int x = heads[i], j = i;
+        for (; j > 0 && heads[j - 1] > x; j--) heads[j] = heads[j - 1];
+        heads[j] = x;
+    }
+}
 
-        if (i != j && problem->capacity[i][j] == 0) {  // Pas de boucle (i != j) et pas de doublons
-            problem->capacity[i][j] = (rand() % 100) + 1;  // Capacité aléatoire entre 1 et 100
-            if (problem->cost) {
-                problem->cost[i][j] = (rand() % 100) + 1;  // Coût aléatoire entre 1 et 100
-            }
-            count++;
+static int gen_compare_int(const void *x, const void *y) {
+    int a = *(const int *)x, b = *(const int *)y;
+    return (a > b) - (a < b);
+}
+
+// Tire capacité et coût des k arcs de la ligne, dans l'ordre des sommets d'arrivée
+static void gen_values(GenRng *r, int k, int *cap, int *cost) {
+    for (int e = 0; e < k; e++) {
+        cap[e] = gen_rng_value(r);
+        cost[e] = gen_rng_value(r);
+    }
+}
+
+static int gen_row_random(const GenParams *P, GenRng *r, int u, int *heads, int *cap, int *cost) {
+    int n = P->n, k = 0;
+    if (P->density <= 0.0) return 0;
+    if (P->density >= GEN_DENSE) {
+        for (int v = 0; v < n; v++) {
+            if (v == u || gen_rng_uniform(r) >= P->density) continue;
+            heads[k] = v;
+            cap[k] = gen_rng_value(r);
+            cost[k] = gen_rng_value(r);
+            k++;
+        }
+    } else {
+        // Graphe peu dense : l'écart jusqu'à la case suivante suit une loi géométrique, on saute directement
+        double lq = log1p(-P->density);
+        double c = -1.0;                                    // Indice parmi les n-1 colonnes v != u
+        while (1) {
+            c += 1.0 + floor(log1p(-gen_rng_uniform(r)) / lq);
+            if (c >= n - 1) break;
+            int v = (int)c;
+            heads[k] = v < u ? v : v + 1;
+            cap[k] = gen_rng_value(r);
+            cost[k] = gen_rng_value(r);
+            k++;
         }
     }
+    return k;
 }
 
-//----------------------------------------------------------
-// Sauvegarde d'un problème de flot dans un fichier texte
-//----------------------------------------------------------
-void save_flow_problem_to_file(FlowProblem *problem, const char *filename) {
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        fprintf(stderr, "Erreur lors de l'ouverture du fichier %s\n", filename);
-        return;
+// Permutation du cadre f vers le cadre f+1 : p -> (mult * p + add) mod a², mult premier avec a².
+// Elle ne dépend que de la graine et de f, chaque ligne la recalcule en O(1).
+static int gen_layered_target(const GenParams *P, int f, int p) {
+    int64_t cells = (int64_t)P->a * P->a;
+    uint64_t x = P->seed ^ (0x9E3779B97F4A7C15ULL * (uint64_t)(f + 1)) ^ 0x5851F42D4C957F2DULL;
+    int64_t mult, add = (int64_t)(splitmix64(&x) % (uint64_t)cells);
+    do {
+        mult = 1 + (int64_t)(splitmix64(&x) % (uint64_t)cells);
+        int64_t g = mult, h = cells;                        // pgcd(mult, a²)
+        while (h) { int64_t t = g % h; g = h; h = t; }
+        if (g == 1) break;
+    } while (1);
+    return (int)((mult * p + add) % cells);
+}
+
+static int gen_row_layered(const GenParams *P, GenRng *r, int u, int *heads, int *cap, int *cost) {
+    int a = P->a, cells = a * a;
+    int f = u / cells, p = u % cells, row = p / a, col = p % a, k = 0;
+    if (row > 0) heads[k++] = u - a;                        // Grille du cadre : quatre voisins
+    if (col > 0) heads[k++] = u - 1;
+    if (col < a - 1) heads[k++] = u + 1;
+    if (row < a - 1) heads[k++] = u + a;
+    int inner = k;
+    if (f < P->b - 1) heads[k++] = (f + 1) * cells + gen_layered_target(P, f, p); // Vers le cadre suivant
+    gen_values(r, k, cap, cost);                           // Têtes déjà croissantes : le cadre suivant vient après
+    for (int e = 0; e < inner; e++) cap[e] = GEN_MAX_VALUE * cells; // Arcs internes : jamais limitants
+    return k;
+}
+
+static int gen_row_paths(const GenParams *P, GenRng *r, int u, int *heads, int *cap, int *cost) {
+    int n = P->n, K = P->a, k = 0;
+    if (u == 0) {                                   // s vers le début de chaque chemin
+        for (int i = 1; i <= K; i++) heads[k++] = 1 + (i - 1) * i / 2;
+    } else if (u < n - 1) {
+        int idx = u - 1;                            // Chemin i (de i sommets) et position j du sommet u
+        int i = (int)((sqrt(8.0 * idx + 1.0) - 1.0) / 2.0) + 1;
+        while (i > 1 && (i - 1) * i / 2 > idx) i--;
+        while (i * (i + 1) / 2 <= idx) i++;
+        int j = idx - (i - 1) * i / 2;
+        heads[k++] = (j == i - 1) ? n - 1 : u + 1; // Suite du chemin, ou t
+        if (i < K) heads[k++] = 1 + i * (i + 1) / 2 + j + 1; // Marche vers le chemin suivant, un cran plus loin
+        gen_sort_heads(heads, k);
     }
+    gen_values(r, k, cap, cost);
+    for (int e = 0; e < k; e++) cap[e] = 1;         // Capacités unitaires : un chemin augmentant par unité
+    return k;
+}
 
-    int n = problem->n;
-    fprintf(file, "%d\n", n);  // Écrire la taille de la matrice
+static int gen_row_grid(const GenParams *P, GenRng *r, int u, int *heads, int *cap, int *cost) {
+    int n = P->n, cols = P->a, rows = P->b, k = 0;
+    if (u == 0) {                                   // s vers la première colonne
+        for (int y = 0; y < rows; y++) heads[k++] = 1 + y * cols;
+    } else if (u < n - 1) {
+        int y = (u - 1) / cols, x = (u - 1) % cols;
+        if (y > 0) heads[k++] = u - cols;
+        if (x > 0) heads[k++] = u - 1;
+        if (x < cols - 1) heads[k++] = u + 1;
+        if (y < rows - 1) heads[k++] = u + cols;
+        if (x == cols - 1) heads[k++] = n - 1;     // Dernière colonne vers t
+    }
+    gen_values(r, k, cap, cost);
+    for (int e = 0; e < k; e++)
+        if (u == 0 || heads[e] == n - 1) cap[e] = GEN_MAX_VALUE * 4; // Accès à s et t non limitants
+    return k;
+}
 
-    // Écrire la matrice des capacités
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            fprintf(file, "%d ", problem->capacity[i][j]);
+static int gen_row_transport(const GenParams *P, GenRng *r, int u, int *heads, int *cap, int *cost) {
+    int n = P->n, p = P->a, q = P->b, k = 0;
+    if (u == 0) {                                   // s vers les offreurs 1..p : capacité = offre
+        for (int i = 1; i <= p; i++) heads[k++] = i;
+        gen_values(r, k, cap, cost);
+    } else if (u <= p) {                            // Offreur vers demandeurs : capacité large, coût de transport
+        for (int j = 0; j < q; j++) {
+            if (gen_rng_uniform(r) >= P->density) continue;
+            heads[k] = p + 1 + j;
+            cap[k] = GEN_MAX_VALUE;
+            cost[k] = gen_rng_value(r);
+            k++;
         }
-        fprintf(file, "\n");
+    } else if (u < n - 1) {                         // Demandeur vers t : capacité = demande
+        heads[k++] = n - 1;
+        gen_values(r, k, cap, cost);
+    }
+    if (u == 0 || u > p)
+        for (int e = 0; e < k; e++) cost[e] = 0;    // Offres et demandes sans coût
+    return k;
+}
+
+// R-MAT ligne par ligne : la ligne x (identifiant interne) reçoit en moyenne m × P(x) arcs, où P(x) est le
+// produit de (a + b) pour chaque bit nul de x et de (c + d) pour chaque bit à 1. Chaque bit de la colonne
+// est ensuite tiré selon le bit correspondant de x : 1 avec la probabilité b / (a + b) ou d / (c + d).
+// Les sommets 1 et n-1 sont échangés : t devient le deuxième sommet le plus connecté au lieu du dernier.
+static int gen_rmat_label(const GenParams *P, int x) {
+    return x == 1 ? P->n - 1 : x == P->n - 1 ? 1 : x;
+}
+
+static int gen_poisson(GenRng *r, double lambda) {
+    if (lambda < 30.0) {                            // Méthode de Knuth
+        double limit = exp(-lambda), prod = gen_rng_uniform(r);
+        int k = 0;
+        while (prod > limit) {
+            prod *= gen_rng_uniform(r);
+            k++;
+        }
+        return k;
+    }
+    double u1 = gen_rng_uniform(r), u2 = gen_rng_uniform(r); // Approximation normale (Box-Muller)
+    double g = sqrt(-2.0 * log1p(-u1)) * cos(2.0 * M_PI * u2);
+    long k = lround(lambda + sqrt(lambda) * g);
+    return k > 0 ? (int)k : 0;
+}
+
+static int gen_row_rmat(const GenParams *P, GenRng *r, int u, int *heads, int *cap, int *cost) {
+    int n = P->n, scale = P->a, x = gen_rmat_label(P, u);
+    const double ab = GEN_RMAT_A + GEN_RMAT_B, cd = 1.0 - ab;
+    double prob = 1.0;
+    for (int bit = 0; bit < scale; bit++) prob *= ((x >> bit) & 1) ? cd : ab;
+    int draws = gen_poisson(r, (double)GEN_RMAT_EDGE_FACTOR * ((int64_t)1 << scale) * prob);
+    if (draws > n) draws = n;
+    int k = 0;
+    for (int e = 0; e < draws; e++) {
+        int y = 0;
+        for (int bit = scale - 1; bit >= 0; bit--) {
+            double one = ((x >> bit) & 1) ? (1.0 - GEN_RMAT_A - GEN_RMAT_B - GEN_RMAT_C) / cd : GEN_RMAT_B / ab;
+            if (gen_rng_uniform(r) < one) y |= 1 << bit;
+        }
+        if (y >= n) continue;                       // Hors des n sommets retenus
+        int v = gen_rmat_label(P, y);
+        if (v != u) heads[k++] = v;
+    }
+    if (k > 16) qsort(heads, k, sizeof(int), gen_compare_int);
+    else gen_sort_heads(heads, k);
+    int unique = 0;                                 // Arcs multiples fusionnés
+    for (int e = 0; e < k; e++)
+        if (unique == 0 || heads[e] != heads[unique - 1]) heads[unique++] = heads[e];
+    gen_values(r, unique, cap, cost);
+    return unique;
+}
+
+// Génère la ligne u : heads[] reçoit les sommets v (croissants) tels que u->v existe, cap[] et cost[]
+// leurs valeurs. Le coût est tiré même s'il n'est pas écrit, pour que les capacités ne changent pas.
+// Retourne le nombre d'arcs de la ligne.
+static int gen_row(const GenParams *P, int u, int *heads, int *cap, int *cost) {
+    GenRng r;
+    gen_rng_seed(&r, P->seed, u);
+    switch (P->family) {
+    case GEN_LAYERED: return gen_row_layered(P, &r, u, heads, cap, cost);
+    case GEN_PATHS: return gen_row_paths(P, &r, u, heads, cap, cost);
+    case GEN_GRID: return gen_row_grid(P, &r, u, heads, cap, cost);
+    case GEN_TRANSPORT: return gen_row_transport(P, &r, u, heads, cap, cost);
+    case GEN_RMAT: return gen_row_rmat(P, &r, u, heads, cap, cost);
+    default: return gen_row_random(P, &r, u, heads, cap, cost);
+    }
+}
+
+enum { GEN_PASS_COUNT, GEN_PASS_FILL, GEN_PASS_MATRIX, GEN_PASS_ARCS };
+
+// Travail d'un thread : lignes [row_lo, row_hi) pour une passe donnée
+typedef struct {
+    const GenParams *P;
+    int pass;
+    int row_lo, row_hi;
+    int which;                  // GEN_PASS_MATRIX : 0 = capacités, 1 = coûts
+    int *heads, *cap, *cost;    // Ligne courante (n cases)
+    int64_t *row_arcs;          // GEN_PASS_COUNT : arcs de chaque ligne ; GEN_PASS_FILL : position de la ligne
+    int *out_tail, *out_head;   // GEN_PASS_FILL : liste des arcs
+    flow_cap_t *out_cap;        // (à la largeur de la bibliothèque, FLOW_CAP_BITS et FLOW_COST_BITS)
+    flow_cost_t *out_cost;
+    char *buf;                  // Texte produit (GEN_PASS_MATRIX, GEN_PASS_ARCS)
+    size_t len, size;
+    int ok;
+    int too_large;              // GEN_PASS_FILL : une valeur dépasse FLOW_CAP_BITS ou FLOW_COST_BITS
+} GenTask;
+
+static char *gen_put_int(char *p, long long x) {  // Écrit x en décimal, retourne la fin
+    char tmp[24];
+    int k = 0;
+    if (x < 0) {
+        *p++ = '-';
+        x = -x;
     }
+    do {
+        tmp[k++] = (char)('0' + x % 10);
+        x /= 10;
+    } while (x);
+    while (k) *p++ = tmp[--k];
+    return p;
+}
+
+static int gen_reserve(GenTask *T, size_t extra) {  // Garantit extra octets libres dans le tampon
+    if (T->len + extra <= T->size) return 1;
+    size_t size = T->size ? T->size : 4096;
+    while (size < T->len + extra) size *= 2;
+    char *buf = (char *)realloc(T->buf, size);
+    if (!buf) return 0;
+    T->buf = buf;
+    T->size = size;
+    return 1;
+}
 
-    // Si une matrice de coûts existe, l'écrire également
-    if (problem->cost) {
-        for (int i = 0; i < n; i++) {
-            for (int j = 0; j < n; j++) {
-                fprintf(file, "%d ", problem->cost[i][j]);
+static void *gen_worker(void *arg) {
+    GenTask *T = (GenTask *)arg;
+    const GenParams *P = T->P;
+    int n = P->n;
+    T->len = 0;
+    for (int u = T->row_lo; u < T->row_hi && T->ok; u++) {
+        int k = gen_row(P, u, T->heads, T->cap, T->cost);
+        if (T->pass == GEN_PASS_COUNT) {
+            T->row_arcs[u] = k;
+        } else if (T->pass == GEN_PASS_FILL) {
+            int64_t pos = T->row_arcs[u];
+            for (int e = 0; e < k; e++) {
+                T->out_tail[pos + e] = u;
+                T->out_head[pos + e] = T->heads[e];
+                T->out_cap[pos + e] = (flow_cap_t)T->cap[e];
+                if (T->out_cap[pos + e] != T->cap[e]) T->too_large = 1;         // Valeur tronquée à la conversion
+                if (T->out_cost) {
+                    T->out_cost[pos + e] = (flow_cost_t)T->cost[e];
+                    if (T->out_cost[pos + e] != T->cost[e]) T->too_large = 1;
+                }
+            }
+        } else if (T->pass == GEN_PASS_MATRIX) {           // Ligne de matrice : "c " par case, zéros compris
+            if (!gen_reserve(T, (size_t)n * 4 + 2)) { T->ok = 0; break; }
+            char *p = T->buf + T->len;
+            const int *values = T->which ? T->cost : T->cap;
+            for (int v = 0, e = 0; v < n; v++) {
+                if (e < k && T->heads[e] == v) p = gen_put_int(p, values[e++]);
+                else *p++ = '0';
+                *p++ = ' ';
             }
-            fprintf(file, "\n");
+            *p++ = '\n';
+            T->len = p - T->buf;
+        } else {                                            // Arcs DIMACS : "a u v cap" (sommets numérotés à partir de 1)
+            if (!gen_reserve(T, (size_t)k * 32 + 1)) { T->ok = 0; break; }
+            char *p = T->buf + T->len;
+            for (int e = 0; e < k; e++) {
+                *p++ = 'a';
+                *p++ = ' ';
+                p = gen_put_int(p, u + 1);
+                *p++ = ' ';
+                p = gen_put_int(p, T->heads[e] + 1);
+                *p++ = ' ';
+                p = gen_put_int(p, T->cap[e]);
+                *p++ = '\n';
+            }
+            T->len = p - T->buf;
         }
     }
+    return NULL;
+}
 
-    fclose(file);
-    printf("Problème de flot sauvegardé dans le fichier : %s\n", filename);
+// Répartit les lignes [lo, hi) en tranches contiguës sur les threads et attend la fin
+static void gen_run(GenTask *tasks, int num_threads, int lo, int hi) {
+    pthread_t threads[GEN_MAX_THREADS];
+    int started[GEN_MAX_THREADS];
+    for (int k = 0; k < num_threads; k++) {
+        tasks[k].row_lo = lo + (int)((int64_t)(hi - lo) * k / num_threads);
+        tasks[k].row_hi = lo + (int)((int64_t)(hi - lo) * (k + 1) / num_threads);
+        started[k] = (k > 0 && pthread_create(&threads[k], NULL, gen_worker, &tasks[k]) == 0);
+    }
+    gen_worker(&tasks[0]);
+    for (int k = 1; k < num_threads; k++) {
+        if (started[k]) pthread_join(threads[k], NULL);
+        else gen_worker(&tasks[k]);                 // Thread refusé : la tranche est traitée ici
+    }
 }
 
-//----------------------------------------------------------
-// Fonction principale pour générer et sauvegarder des problèmes
-//----------------------------------------------------------
-int main() {
-    srand((unsigned int)time(NULL));  // Initialisation de la graine aléatoire
+// Écrit les lignes de toute la matrice (passe GEN_PASS_MATRIX) ou tous les arcs (GEN_PASS_ARCS) dans f,
+// par paquets de lignes générés en parallèle et écrits dans l'ordre
+static int gen_stream(FILE *f, GenTask *tasks, int num_threads, int pass, int which) {
+    const GenParams *P = tasks[0].P;
+    double row_bytes = (pass == GEN_PASS_MATRIX) ? 2.0 * P->n + 4.0 * P->avg_degree : 16.0 * P->avg_degree; // Estimation
+    int rows = (int)(GEN_BATCH_BYTES / (row_bytes + 1.0));
+    if (rows > GEN_BATCH_ROWS) rows = GEN_BATCH_ROWS;
+    if (rows < 1) rows = 1;
+    for (int lo = 0; lo < P->n; lo += rows * num_threads) {
+        int hi = lo + rows * num_threads < P->n ? lo + rows * num_threads : P->n;
+        for (int k = 0; k < num_threads; k++) {
+            tasks[k].pass = pass;
+            tasks[k].which = which;
+        }
+        gen_run(tasks, num_threads, lo, hi);
+        for (int k = 0; k < num_threads; k++) {
+            if (!tasks[k].ok) return 0;
+            if (fwrite(tasks[k].buf, 1, tasks[k].len, f) != tasks[k].len) return 0;
+        }
+    }
+    return 1;
+}
+
+// Compte les arcs de chaque ligne ; row_arcs[u] devient la position de la ligne u dans la liste des arcs.
+// Retourne le nombre total d'arcs.
+static int64_t gen_count(GenTask *tasks, int num_threads, int64_t *row_arcs) {
+    int n = tasks[0].P->n;
+    for (int k = 0; k < num_threads; k++) {
+        tasks[k].pass = GEN_PASS_COUNT;
+        tasks[k].row_arcs = row_arcs;
+    }
+    gen_run(tasks, num_threads, 0, n);
+    int64_t total = 0;
+    for (int u = 0; u < n; u++) {
+        int64_t k = row_arcs[u];
+        row_arcs[u] = total;
+        total += k;
+    }
+    return total;
+}
+
+// Génère un problème et l'écrit dans filename au format demandé. Retourne 1 en cas de succès.
+static int generate_flow_problem(const GenParams *P, GenFormat format, int num_threads, const char *filename) {
+    int n = P->n;
+    GenTask tasks[GEN_MAX_THREADS];
+    int ok = 1;
+    for (int k = 0; k < num_threads; k++) {
+        memset(&tasks[k], 0, sizeof(GenTask));
+        tasks[k].P = P;
+        tasks[k].ok = 1;
+        tasks[k].heads = (int *)malloc(n * sizeof(int));
+        tasks[k].cap = (int *)malloc(n * sizeof(int));
+        tasks[k].cost = (int *)malloc(n * sizeof(int));
+        ok = ok && tasks[k].heads && tasks[k].cap && tasks[k].cost;
+    }
+    int64_t *row_arcs = (format != GEN_TEXT) ? (int64_t *)malloc(n * sizeof(int64_t)) : NULL;
+    if (format != GEN_TEXT && !row_arcs) ok = 0;
+
+    if (ok && format == GEN_BINARY) {
+        int64_t m = gen_count(tasks, num_threads, row_arcs);
+        if (2 * m > INT_MAX) {
+            fprintf(stderr, "%s : %lld arcs, trop pour le format binaire (indices 32 bits).\n", filename, (long long)m);
+            ok = 0;
+        }
+        FlowNetwork G;
+        int *tail = NULL, *head = NULL;
+        flow_cap_t *cap = NULL;
+        flow_cost_t *cost = NULL;
+        if (ok) {
+            size_t count = m > 0 ? (size_t)m : 1;
+            tail = (int *)malloc(count * sizeof(int));
+            head = (int *)malloc(count * sizeof(int));
+            cap = (flow_cap_t *)malloc(count * sizeof(flow_cap_t));
+            cost = P->with_cost ? (flow_cost_t *)malloc(count * sizeof(flow_cost_t)) : NULL;
+            ok = tail && head && cap && (cost || !P->with_cost);
+        }
+        if (ok) {
+            for (int k = 0; k < num_threads; k++) {
+                tasks[k].pass = GEN_PASS_FILL;
+                tasks[k].out_tail = tail;
+                tasks[k].out_head = head;
+                tasks[k].out_cap = cap;
+                tasks[k].out_cost = cost;
+            }
+            gen_run(tasks, num_threads, 0, n);
+            for (int k = 0; k < num_threads; k++) {
+                if (tasks[k].too_large) {
+                    fprintf(stderr, "%s : valeur trop grande pour FLOW_CAP_BITS / FLOW_COST_BITS.\n", filename);
+                    ok = 0;
+                    break;
+                }
+            }
+        }
+        if (ok) {
+            G.n = n;
+            G.s = 0;                        // Même convention que les fichiers texte : s = 0, t = n-1
+            G.t = n - 1;
+            G.isMinCost = P->with_cost;
+            ok = build_csr(&G, (int)m, tail, head, cap, cost);
+            free(tail); free(head); free(cap); free(cost);
+            tail = head = NULL;
+            cap = NULL;
+            cost = NULL;
+            if (!ok) fprintf(stderr, "Mémoire insuffisante pour le graphe n = %d.\n", n);
+            else {
+                ok = write_binary_file(filename, &G);
+                free_flow_network(&G);
+            }
+        }
+        free(tail); free(head); free(cap); free(cost);
+    } else if (ok) {
+        FILE *file = fopen(filename, "w");
+        if (!file) {
+            fprintf(stderr, "Erreur lors de l'ouverture du fichier %s\n", filename);
+            ok = 0;
+        } else {
+            if (format == GEN_TEXT) {
+                fprintf(file, "%d\n", n);                               // Taille, puis matrice des capacités
+                ok = gen_stream(file, tasks, num_threads, GEN_PASS_MATRIX, 0);
+                if (ok && P->with_cost) ok = gen_stream(file, tasks, num_threads, GEN_PASS_MATRIX, 1); // Coûts
+            } else {
+                int64_t m = gen_count(tasks, num_threads, row_arcs);   // L'en-tête DIMACS annonce m
+                fprintf(file, "c Graphe %s : graine %llu", gen_family_names[P->family], (unsigned long long)P->seed);
+                if (P->family == GEN_RANDOM || P->family == GEN_TRANSPORT)   // Seules familles qui utilisent -d
+                    fprintf(file, ", densité %g", P->density);
+                fprintf(file, "\n");
+                fprintf(file, "p max %d %lld\nn 1 s\nn %d t\n", n, (long long)m, n);
+                ok = gen_stream(file, tasks, num_threads, GEN_PASS_ARCS, 0);
+            }
+            if (fclose(file) != 0) ok = 0;
+            if (!ok) fprintf(stderr, "Erreur d'écriture dans %s\n", filename);
+        }
+    }
+
+    for (int k = 0; k < num_threads; k++) {
+        free(tasks[k].heads);
+        free(tasks[k].cap);
+        free(tasks[k].cost);
+        free(tasks[k].buf);
+    }
+    free(row_arcs);
+    return ok;
+}
 
-    // Tailles des problèmes de flot à générer
-    int sizes[] = {10, 20, 40, 100, 400, 1000, 4000, 10000};
-    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+// Écrit la famille grid au format grille de la bibliothèque (read_grid_file) : une ligne par cellule au lieu
+// des arcs. La cellule (x, y) est le sommet 1 + y * colonnes + x ; ses capacités sont celles de gen_row, la
+// source alimente la première colonne et la dernière colonne se déverse dans le puits. Retourne 1 en cas de succès.
+static int generate_grid_file(const GenParams *P, const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Erreur lors de l'ouverture du fichier %s\n", filename);
+        return 0;
+    }
+    int cols = P->a, rows = P->b, n = P->n;
+    int heads[8], cap[8], cost[8];
+    fprintf(file, "grid %d %d\n", cols, rows);
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            int u = 1 + y * cols + x;
+            int value[6] = { 0, 0, 0, 0, 0, 0 };    // Puits, +x, -x, +y, -y (la source vient de la ligne de s)
+            int k = gen_row(P, u, heads, cap, cost);
+            for (int e = 0; e < k; e++) {
+                int v = heads[e];
+                int slot = v == n - 1 ? 0 : v == u + 1 ? 1 : v == u - 1 ? 2 : v == u + cols ? 3 : 4;
+                value[slot] = cap[e];
+            }
+            fprintf(file, "%d %d %d %d %d %d\n", x == 0 ? GEN_MAX_VALUE * 4 : 0, value[0],
+                    value[1], value[2], value[3], value[4]);
+        }
+    }
+    int ok = !ferror(file);
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Erreur d'écriture dans %s\n", filename);
+    return ok;
+}
 
-    for (int i = 0; i < num_sizes; i++) {
-        int n = sizes[i];
+static double gen_now(void) {     // Horloge monotone, en secondes
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
 
-        // Initialiser le problème de flot
-        FlowProblem problem;
-        problem.n = n;
-        problem.capacity = allocate_matrix(n);
-        problem.cost = allocate_matrix(n);
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage : %s [-g famille] [-n tailles] [-d densité] [-s graine] [-f text|dimacs|bin|grid] [-m] [-j threads] [-o dossier]\n"
+            "  -g  famille : random (défaut), layered, paths, grid, transport ou rmat\n"
+            "  -n  tailles (nombres de sommets visés) séparées par des virgules (défaut : 10,20,40,100,400,1000,4000,10000)\n"
+            "  -d  random, transport : probabilité qu'un couple (u, v) porte un arc (défaut : 0.5)\n"
+            "  -s  graine : mêmes graine, taille et densité = même fichier (défaut : l'heure)\n"
+            "  -f  text (matrices, défaut), dimacs (p max, sans coûts), bin (format binaire CSR)\n"
+            "      ou grid (famille grid seulement : une ligne de capacités par cellule, sans coûts)\n"
+            "  -m  sans matrice des coûts (flot max seulement)\n"
+            "  -j  threads, 0 = un par cœur (défaut : 0) ; le fichier ne dépend pas du nombre de threads\n"
+            "  -o  dossier des fichiers flow_problem_nX (random) ou famille_nX, en .txt, .max, .bin ou .grid (défaut : dossier courant)\n"
+            "Hors random, le nombre exact de sommets X dépend de la forme de la famille.\n", prog);
+}
 
-        // Générer les matrices aléatoires
-        generate_random_flow_problem(&problem);
+// Fonction principale : génère et sauvegarde un problème par taille demandée
+int main(int argc, char **argv) {
+    GenParams P;
+    P.family = GEN_RANDOM;
+    P.density = 0.5;                        // Environ la moitié des arêtes possibles
+    P.seed = (uint64_t)time(NULL);
+    P.with_cost = 1;
+    GenFormat format = GEN_TEXT;
+    int num_threads = 0;
+    char default_sizes[] = "10,20,40,100,400,1000,4000,10000";
+    char *sizes = default_sizes;
+    const char *dir = ".";
 
-        // Sauvegarder dans un fichier
-        char filename[50];
-        sprintf(filename, "flow_problem_n%d.txt", n);  // Exemple : flow_problem_n10.txt
-        save_flow_problem_to_file(&problem, filename);
+    int c;
+    while ((c = getopt(argc, argv, "g:n:d:s:f:mj:o:h")) != -1) {
+        switch (c) {
+        case 'g':
+            for (P.family = 0; P.family < GEN_NUM_FAMILIES; P.family++)
+                if (strcmp(optarg, gen_family_names[P.family]) == 0) break;
+            if (P.family == GEN_NUM_FAMILIES) {
+                fprintf(stderr, "Famille inconnue : %s\n", optarg);
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'n': sizes = optarg; break;
+        case 'd': P.density = atof(optarg); break;
+        case 's': P.seed = strtoull(optarg, NULL, 10); break;
+        case 'f':
+            if (strcmp(optarg, "text") == 0) format = GEN_TEXT;
+            else if (strcmp(optarg, "dimacs") == 0) format = GEN_DIMACS;
+            else if (strcmp(optarg, "bin") == 0) format = GEN_BINARY;
+            else if (strcmp(optarg, "grid") == 0) format = GEN_GRID_CELLS;
+            else { usage(argv[0]); return 1; }
+            break;
+        case 'm': P.with_cost = 0; break;
+        case 'j': num_threads = atoi(optarg); break;
+        case 'o': dir = optarg; break;
+        default: usage(argv[0]); return c == 'h' ? 0 : 1;
+        }
+    }
+    if (P.density < 0.0 || P.density > 1.0) {
+        fprintf(stderr, "La densité doit être comprise entre 0 et 1.\n");
+        return 1;
+    }
+    if (format == GEN_GRID_CELLS && P.family != GEN_GRID) {
+        fprintf(stderr, "Le format grid ne s'applique qu'à la famille grid.\n");
+        return 1;
+    }
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (num_threads > GEN_MAX_THREADS) num_threads = GEN_MAX_THREADS;
+    printf("Graine : %llu (famille %s, densité %g, %d thread(s))\n", (unsigned long long)P.seed,
+           gen_family_names[P.family], P.density, num_threads);
 
-        // Libérer la mémoire
-        free_matrix(problem.capacity, n);
-        free_matrix(problem.cost, n);
+    int errors = 0;
+    const char *ext = format == GEN_TEXT ? "txt" : format == GEN_DIMACS ? "max" : format == GEN_BINARY ? "bin" : "grid";
+    for (char *tok = strtok(sizes, ","); tok; tok = strtok(NULL, ",")) {
+        if (!gen_layout(&P, atoi(tok))) {
+            fprintf(stderr, "Taille invalide : %s\n", tok);
+            errors++;
+            continue;
+        }
+        char filename[1024];
+        if (P.family == GEN_RANDOM)     // Exemple : flow_problem_n10.txt, grid_n102.bin
+            snprintf(filename, sizeof(filename), "%s/flow_problem_n%d.%s", dir, P.n, ext);
+        else
+            snprintf(filename, sizeof(filename), "%s/%s_n%d.%s", dir, gen_family_names[P.family], P.n, ext);
+        double start = gen_now();
+        int generated = format == GEN_GRID_CELLS ? generate_grid_file(&P, filename)
+                                                 : generate_flow_problem(&P, format, num_threads, filename);
+        if (generated)
+            printf("Problème de flot sauvegardé dans le fichier : %s (%.2f s)\n", filename, gen_now() - start);
+        else
+            errors++;
     }
 
-    printf("Tous les problèmes de flot ont été générés et sauvegardés.\n");
-    return 0;
+    if (!errors) printf("Tous les problèmes de flot ont été générés et sauvegardés.\n");
+    return errors ? 1 : 0;
 }
@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flow.h"       // Lecture des fichiers et format binaire (bibliothèque commune)
+
+// Fonction main : conversion des fichiers texte (matrices) donnés en argument au format binaire.
+// fichier.txt devient fichier.bin, que read_input_file projette ensuite en mémoire.
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage : %s fichier.txt [fichier2.txt ...]\n", argv[0]);
+        return 1;
+    }
+
+    int errors = 0;
+    for (int i = 1; i < argc; i++) {
+        FlowNetwork G;
+        if (!read_input_file(argv[i], &G)) {       // Lit le fichier texte (ou binaire)
+            errors++;
+            continue;
+        }
+
+        char out[1024];                             // Nom de sortie : extension .txt remplacée par .bin
+        size_t len = strlen(argv[i]);
+        if (len >= 4 && strcmp(argv[i] + len - 4, ".txt") == 0) len -= 4;
+        snprintf(out, sizeof(out), "%.*s.bin", (int)len, argv[i]);
+
+        if (write_binary_file(out, &G)) {
+            printf("%s -> %s (%d sommets, %d arcs%s)\n", argv[i], out, G.n, G.m / 2, G.cost ? ", avec coûts" : "");
+        } else {
+            errors++;
+        }
+        free_flow_network(&G);
+    }
+
+    return errors ? 1 : 0;
+}
@@ -1,27 +1,41 @@
 import pandas as pd
 import matplotlib.pyplot as plt
 
-# Charger les données de max_values.txt
-max_values = pd.read_csv("max_values.txt", delim_whitespace=True, header=None, names=["n", "time_FF", "time_PR", "time_MIN"])
+# Charger les résultats du benchmark (une ligne par instance et par algorithme)
+results = pd.read_csv("results.csv")
 
 # Vérification des données chargées
-print(max_values.head())
+print(results.head())
 
-# Tracer les courbes des temps maximaux pour chaque algorithme
-plt.plot(max_values["n"], max_values["time_FF"], label="Ford-Fulkerson (FF)", marker="o")
-plt.plot(max_values["n"], max_values["time_PR"], label="Push-Relabel (PR)", marker="s")
-plt.plot(max_values["n"], max_values["time_MIN"], label="Min-Cost Flow (MIN)", marker="^")
+# Noms affichés et marqueurs de chaque algorithme
+algorithmes = {
+    "ff": ("Ford-Fulkerson (FF)", "o"),
+    "pr": ("Push-Relabel (PR)", "s"),
+    "min": ("Min-Cost Flow (MIN)", "^"),
+    "dinic": ("Dinic (DINIC)", "d"),
+    "prhl": ("Push-Relabel plus haute étiquette (PRHL)", "v"),
+    "dij": ("Min-Cost Flow Dijkstra (MIN_DIJ)", ">"),
+    "ns": ("Simplexe des réseaux (NS)", "<"),
+    "cs": ("Ford-Fulkerson mise à l'échelle (CS)", "P"),
+}
+
+# Tracer la médiane des temps pour chaque algorithme, avec l'intervalle min - p95
+for algo, (label, marker) in algorithmes.items():
+    data = results[results["algorithm"] == algo].sort_values("n")
+    if data.empty:
+        continue
+    line, = plt.plot(data["n"], data["median_s"], label=label, marker=marker)
+    plt.fill_between(data["n"], data["min_s"], data["p95_s"], color=line.get_color(), alpha=0.15)
 
 # Configuration du graphique
 plt.xscale("log")  # Échelle logarithmique pour n
 plt.yscale("log")  # Facultatif : échelle logarithmique pour les temps si nécessaire
 plt.xlabel("Taille du graphe (n)")
-plt.ylabel("Temps maximal (s)")
-plt.title("Comparaison des Temps Maximaux pour Chaque Algorithme")
+plt.ylabel("Temps médian (s)")
+plt.title("Comparaison des Temps Médians pour Chaque Algorithme")
 plt.legend()
 plt.grid(True)
 
 # Afficher ou sauvegarder le graphique
-plt.savefig("max_times_graph.png")  # Sauvegarde comme image
+plt.savefig("median_times_graph.png")  # Sauvegarde comme image
 plt.show()
-